@@ -51,6 +51,7 @@
 #include "directory.h"
 #include "filehdr.h"
 #include "filesys.h"
+#include "memorymanager.h"
 
 // Sectors containing the file headers for the bitmap of free sectors,
 // and the directory of files.  These file headers are placed in well-known 
@@ -94,6 +95,10 @@ FileSystem::FileSystem(bool format)
 	freeMap->Mark(FreeMapSector);	    
 	freeMap->Mark(DirectorySector);
 
+    // The end of the disk is the swap area for demand paging.
+	for (int i = FirstSwapSector; i < NumSectors; i++)
+	    freeMap->Mark(i);
+
     // Second, allocate space for the data blocks containing the contents
     // of the directory and bitmap files.  There better be enough space!
 
@@ -17,11 +17,32 @@
 
 #include "copyright.h"
 #include "utility.h"
+#include "debug.h"
 
 // Definitions helpful for representing a bitmap as an array of integers
 const int BitsInByte =	8;
 const int BitsInWord = sizeof(unsigned int) * BitsInByte;
 
+// Return the index of the lowest set bit of a word, which must not
+// be zero.  Used to search bitmaps a word at a time.
+
+inline int
+FirstSet(unsigned int word)
+{
+    ASSERT(word != 0);
+#ifdef __GNUC__
+    return __builtin_ctz(word);
+#else
+    int bit = 0;
+
+    while ((word & 1) == 0) {
+	word >>= 1;
+	bit++;
+    }
+    return bit;
+#endif
+}
+
 // The following class defines a "bitmap" -- an array of bits,
 // each of which can be independently set, cleared, and tested.
 //
@@ -0,0 +1,236 @@
+// heap.cc
+//     	Routines to manage a priority queue kept as a binary heap.
+//
+//	The heap starts small and doubles in size when it fills up, so
+//	Insert is amortized logarithmic time.
+//
+//     	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+const int InitialHeapSize = 16;	// how big a heap do we start with
+
+//----------------------------------------------------------------------
+// Heap<T>::Heap
+//	Initialize an empty heap.
+//
+//	"comp" is the function for ordering items: it returns -1 if its
+//		first argument belongs nearer the front, 0 if it doesn't
+//		matter, and 1 otherwise
+//	"place" if not NULL, is called with an item and its new index
+//		each time the item moves, and with -1 when it is removed
+//----------------------------------------------------------------------
+
+template <class T>
+Heap<T>::Heap(int (*comp)(T x, T y), void (*place)(T x, int index))
+{
+    compare = comp;
+    this->place = place;
+    size = InitialHeapSize;
+    items = new T[size];
+    numInHeap = 0;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::~Heap
+//	De-allocate the heap.  The items are the caller's to delete.
+//----------------------------------------------------------------------
+
+template <class T>
+Heap<T>::~Heap()
+{
+    delete [] items;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Put
+//	Store an item at an index, and tell it it's there.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Put(int index, T item)
+{
+    items[index] = item;
+    if (place != NULL)
+	(*place)(item, index);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SiftUp, Heap<T>::SiftDown
+//	Move an item towards the front of the heap while it is smaller
+//	than its parent, or towards the back while it is larger than
+//	the smaller of its children.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SiftUp(int index)
+{
+    T item = items[index];
+
+    while (index > 0) {
+	int parent = (index - 1) / 2;
+
+	if (compare(item, items[parent]) >= 0)
+	    break;
+	Put(index, items[parent]);
+	index = parent;
+    }
+    Put(index, item);
+}
+
+template <class T>
+void
+Heap<T>::SiftDown(int index)
+{
+    T item = items[index];
+
+    for (;;) {
+	int child = 2 * index + 1;
+
+	if (child >= numInHeap)
+	    break;
+	if (child + 1 < numInHeap && compare(items[child + 1], items[child]) < 0)
+	    child++;
+	if (compare(items[child], item) >= 0)
+	    break;
+	Put(index, items[child]);
+	index = child;
+    }
+    Put(index, item);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Insert
+//	Put an item into the heap, growing the heap if it is full.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Insert(T item)
+{
+    if (numInHeap == size) {
+	T *bigger = new T[size * 2];
+
+	for (int i = 0; i < numInHeap; i++)
+	    bigger[i] = items[i];
+	delete [] items;
+	items = bigger;
+	size *= 2;
+    }
+    items[numInHeap] = item;
+    numInHeap++;
+    SiftUp(numInHeap - 1);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::RemoveMin
+//	Take the smallest item out of the heap, and return it.
+//	The heap must not be empty.
+//----------------------------------------------------------------------
+
+template <class T>
+T
+Heap<T>::RemoveMin()
+{
+    return Remove(0);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Remove
+//	Take the item at "index" out of the heap, and return it.  The
+//	last item takes its place, and is moved up or down to where it
+//	belongs.
+//----------------------------------------------------------------------
+
+template <class T>
+T
+Heap<T>::Remove(int index)
+{
+    T item = items[index];
+
+    ASSERT(index >= 0 && index < numInHeap);
+    numInHeap--;
+    if (index < numInHeap) {
+	items[index] = items[numInHeap];
+	Changed(index);
+    }
+    if (place != NULL)
+	(*place)(item, -1);
+    return item;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Changed
+//	Put the item at "index" back in order, after the caller has
+//	changed what it compares by.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Changed(int index)
+{
+    ASSERT(index >= 0 && index < numInHeap);
+    if (index > 0 && compare(items[index], items[(index - 1) / 2]) < 0)
+	SiftUp(index);
+    else
+	SiftDown(index);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SanityCheck
+//	Is this still a legal heap?  Every item must be no smaller than
+//	its parent.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SanityCheck() const
+{
+    ASSERT(numInHeap >= 0 && numInHeap <= size);
+    for (int i = 1; i < numInHeap; i++)
+	ASSERT(compare(items[(i - 1) / 2], items[i]) <= 0);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SelfTest
+//	Test whether this module is working: put the items in, take one
+//	out of the middle, then check the rest come out smallest first.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SelfTest(T *p, int numEntries)
+{
+    int i;
+    T removed, last;
+
+    ASSERT(IsEmpty());
+    for (i = 0; i < numEntries; i++) {
+	Insert(p[i]);
+	SanityCheck();
+    }
+    ASSERT(NumInHeap() == numEntries);
+    for (i = 0; i < numEntries; i++)
+	ASSERT(compare(Min(), p[i]) <= 0);
+
+    removed = Remove(numEntries / 2);
+    SanityCheck();
+    last = RemoveMin();
+    for (i = 2; i < numEntries; i++) {
+	T next = RemoveMin();
+
+	ASSERT(compare(last, next) <= 0);
+	SanityCheck();
+	last = next;
+    }
+    ASSERT(IsEmpty());
+
+    Insert(removed);		// and back to empty
+    ASSERT(RemoveMin() == removed);
+}
@@ -0,0 +1,79 @@
+// heap.h
+//	Data structures to manage a priority queue, kept as a binary
+//	heap in an array: the smallest item can be found in constant
+//	time, and items can be put in or taken out in time logarithmic
+//	in the number of items.
+//
+//	Items are ordered by a comparison function, as for SortedList.
+//	Optionally, the heap can tell each item where it is in the array
+//	whenever it moves, so that the caller can later remove an item
+//	from the middle of the heap, or put it back in order after its
+//	key has changed, without searching for it.
+//
+//	Allocation and deallocation of the items in the heap are to be
+//	done by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "copyright.h"
+#include "debug.h"
+
+// The following class defines a "heap" -- a priority queue whose
+// smallest item (according to "compare") is always at the front.
+// Items that compare equal come out in no particular order; callers
+// that care should break ties in the comparison function.
+
+template <class T>
+class Heap {
+  public:
+    Heap(int (*comp)(T x, T y), void (*place)(T x, int index) = NULL);
+				// initialize an empty heap; "place" is
+				// called whenever an item moves, with -1
+				// when it leaves the heap
+    ~Heap();			// de-allocate the heap
+
+    void Insert(T item);	// Put item into the heap
+    T Min() { ASSERT(numInHeap > 0); return items[0]; }
+				// Return the smallest item, without
+				// removing it
+    T RemoveMin();		// Take the smallest item out of the heap
+    T Remove(int index);	// Take the item at "index" out of the heap
+    void Changed(int index);	// The key of the item at "index" has
+				// changed; put it back in order
+
+    T Item(int index) { ASSERT(index >= 0 && index < numInHeap);
+			return items[index]; }
+				// Return the item at "index", for
+				// looking at every item, in no
+				// particular order
+    int NumInHeap() { return numInHeap; }
+    bool IsEmpty() { return numInHeap == 0; }
+
+    void SanityCheck() const;	// is this still a legal heap?
+    void SelfTest(T *p, int numEntries);
+				// verify module is working
+
+  private:
+    T *items;			// the heap: each item is no larger
+				// than the two at 2i+1 and 2i+2
+    int size;			// how many items there is room for
+    int numInHeap;		// how many items there are
+
+    int (*compare)(T x, T y);	// function for ordering items
+    void (*place)(T x, int index);
+				// function telling an item where it is
+
+    void Put(int index, T item);// store an item, and tell it where
+    void SiftUp(int index);	// move an item up or down until it
+    void SiftDown(int index);	// is in order
+};
+
+#include "heap.cc"		// templates are really like macros
+				// so needs to be included in every
+				// file that uses the template
+#endif // HEAP_H
@@ -1,6 +1,7 @@
 // libtest.cc 
 //	Driver code to call self-test routines for standard library
-//	classes -- bitmaps, lists, sorted lists, and hash tables.
+//	classes -- bitmaps, lists, sorted lists, hash tables, heaps, and
+//	red-black trees.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -11,6 +12,8 @@
 #include "bitmap.h"
 #include "list.h"
 #include "hash.h"
+#include "heap.h"
+#include "rbtree.h"
 #include "sysdep.h"
 
 //----------------------------------------------------------------------
@@ -53,6 +56,16 @@ HashKey(char *str) {
 // Array of values to be inserted into a List or SortedList. 
 static int listTestVector[] = { 9, 5, 7 };
 
+// Array of values to be inserted into a Heap.  There are enough
+// here for it to grow, and some of them are the same.
+static int heapTestVector[] = { 9, 5, 7, 3, 8, 1, 6, 2, 4, 0, 5, 12, 10,
+	11, 3, 15, 14, 13, 7 };
+
+// Array of values to be inserted into a RBTree.  They must all be
+// different.
+static int treeTestVector[] = { 9, 5, 7, 3, 8, 1, 6, 2, 4, 0, 12, 10,
+	11, 15, 14, 13 };
+
 // Array of values to be inserted into the HashTable
 // There are enough here to force a ReHash().
 static char *hashTestVector[] = { "0", "1", "2", "3", "4", "5", "6",
@@ -60,8 +73,8 @@ static char *hashTestVector[] = { "0", "1", "2", "3", "4", "5", "6",
 
 //----------------------------------------------------------------------
 // LibSelfTest
-//	Run self tests on bitmaps, lists, sorted lists, and 
-//	hash tables.
+//	Run self tests on bitmaps, lists, sorted lists, hash tables,
+//	heaps, and red-black trees.
 //----------------------------------------------------------------------
 
 void
@@ -71,15 +84,21 @@ LibSelfTest () {
     SortedList<int> *sortList = new SortedList<int>(IntCompare);
     HashTable<int, char *> *hashTable = 
 	new HashTable<int, char *>(HashKey, HashInt);
+    Heap<int> *heap = new Heap<int>(IntCompare);
+    RBTree<int> *tree = new RBTree<int>(IntCompare);
 	
 		
     map->SelfTest();
     list->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
     sortList->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
     hashTable->SelfTest(hashTestVector, sizeof(hashTestVector)/sizeof(char *));
+    heap->SelfTest(heapTestVector, sizeof(heapTestVector)/sizeof(int));
+    tree->SelfTest(treeTestVector, sizeof(treeTestVector)/sizeof(int));
 
     delete map;
     delete list;
     delete sortList;
     delete hashTable;
+    delete heap;
+    delete tree;
 }
@@ -0,0 +1,437 @@
+// rbtree.cc
+//     	Routines to manage a sorted set kept as a red-black tree.
+//
+//	The balancing follows Cormen, Leiserson, Rivest and Stein,
+//	"Introduction to Algorithms", chapter 13, with a single black
+//	sentinel node standing in for every leaf.
+//
+//     	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+//----------------------------------------------------------------------
+// RBTree<T>::RBTree
+//	Initialize an empty tree.
+//
+//	"comp" is the function for ordering items: it returns -1 if its
+//		first argument belongs nearer the front, 0 if they are
+//		the same item, and 1 otherwise
+//----------------------------------------------------------------------
+
+template <class T>
+RBTree<T>::RBTree(int (*comp)(T x, T y))
+{
+    compare = comp;
+    nil = new RBNode<T>(T());
+    nil->red = FALSE;
+    nil->left = nil->right = nil->parent = nil;
+    root = leftmost = nil;
+    numInTree = 0;
+}
+
+//----------------------------------------------------------------------
+// RBTree<T>::~RBTree
+//	De-allocate the tree.  The items are the caller's to delete.
+//----------------------------------------------------------------------
+
+template <class T>
+RBTree<T>::~RBTree()
+{
+    DeleteSubtree(root);
+    delete nil;
+}
+
+template <class T>
+void
+RBTree<T>::DeleteSubtree(RBNode<T> *node)
+{
+    if (node == nil)
+	return;
+    DeleteSubtree(node->left);
+    DeleteSubtree(node->right);
+    delete node;
+}
+
+//----------------------------------------------------------------------
+// RBTree<T>::Find, RBTree<T>::Minimum
+//	Return the node holding an item (or nil if it isn't in the
+//	tree), or the node with the smallest item in a subtree.
+//----------------------------------------------------------------------
+
+template <class T>
+RBNode<T> *
+RBTree<T>::Find(T item)
+{
+    RBNode<T> *node = root;
+
+    while (node != nil) {
+	int order = compare(item, node->item);
+
+	if (order == 0)
+	    break;
+	node = (order < 0) ? node->left : node->right;
+    }
+    return node;
+}
+
+template <class T>
+RBNode<T> *
+RBTree<T>::Minimum(RBNode<T> *node)
+{
+    while (node->left != nil)
+	node = node->left;
+    return node;
+}
+
+//----------------------------------------------------------------------
+// RBTree<T>::RotateLeft, RBTree<T>::RotateRight
+//	Turn a node's right child into its parent (or its left child),
+//	keeping the items in order.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+RBTree<T>::RotateLeft(RBNode<T> *node)
+{
+    RBNode<T> *child = node->right;
+
+    node->right = child->left;
+    if (child->left != nil)
+	child->left->parent = node;
+    Transplant(node, child);
+    child->left = node;
+    node->parent = child;
+}
+
+template <class T>
+void
+RBTree<T>::RotateRight(RBNode<T> *node)
+{
+    RBNode<T> *child = node->left;
+
+    node->left = child->right;
+    if (child->right != nil)
+	child->right->parent = node;
+    Transplant(node, child);
+    child->right = node;
+    node->parent = child;
+}
+
+//----------------------------------------------------------------------
+// RBTree<T>::Transplant
+//	Hang "node" (which may be nil) where "old" hangs now.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+RBTree<T>::Transplant(RBNode<T> *old, RBNode<T> *node)
+{
+    if (old->parent == nil)
+	root = node;
+    else if (old == old->parent->left)
+	old->parent->left = node;
+    else
+	old->parent->right = node;
+    node->parent = old->parent;
+}
+
+//----------------------------------------------------------------------
+// RBTree<T>::Insert
+//	Put an item into the tree, as a red leaf, then recolor and
+//	rotate until no red node has a red parent.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+RBTree<T>::Insert(T item)
+{
+    RBNode<T> *node = new RBNode<T>(item);
+    RBNode<T> *parent = nil;
+    RBNode<T> *ptr = root;
+
+    while (ptr != nil) {
+	parent = ptr;
+	ASSERT(compare(item, ptr->item) != 0);
+	ptr = (compare(item, ptr->item) < 0) ? ptr->left : ptr->right;
+    }
+    node->parent = parent;
+    node->left = node->right = nil;
+    node->red = TRUE;
+    if (parent == nil)
+	root = node;
+    else if (compare(item, parent->item) < 0)
+	parent->left = node;
+    else
+	parent->right = node;
+    InsertFixup(node);
+
+    if (leftmost == nil || compare(item, leftmost->item) < 0)
+	leftmost = node;
+    numInTree++;
+}
+
+template <class T>
+void
+RBTree<T>::InsertFixup(RBNode<T> *node)
+{
+    while (node->parent->red) {
+	RBNode<T> *parent = node->parent;
+	RBNode<T> *grandparent = parent->parent;
+
+	if (parent == grandparent->left) {
+	    RBNode<T> *uncle = grandparent->right;
+
+	    if (uncle->red) {
+		parent->red = uncle->red = FALSE;
+		grandparent->red = TRUE;
+		node = grandparent;
+	    } else {
+		if (node == parent->right) {
+		    node = parent;
+		    RotateLeft(node);
+		}
+		node->parent->red = FALSE;
+		node->parent->parent->red = TRUE;
+		RotateRight(node->parent->parent);
+	    }
+	} else {
+	    RBNode<T> *uncle = grandparent->left;
+
+	    if (uncle->red) {
+		parent->red = uncle->red = FALSE;
+		grandparent->red = TRUE;
+		node = grandparent;
+	    } else {
+		if (node == parent->left) {
+		    node = parent;
+		    RotateRight(node);
+		}
+		node->parent->red = FALSE;
+		node->parent->parent->red = TRUE;
+		RotateLeft(node->parent->parent);
+	    }
+	}
+    }
+    root->red = FALSE;
+}
+
+//----------------------------------------------------------------------
+// RBTree<T>::Remove
+//	Take an item out of the tree.  A node with two children is
+//	replaced by its successor; if a black node has gone from a path,
+//	recolor and rotate until every path has as many again.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+RBTree<T>::Remove(T item)
+{
+    RBNode<T> *node = Find(item);
+    RBNode<T> *moved = node;		// the node that leaves its place
+    RBNode<T> *child;			// and the one that takes it
+    bool movedWasRed = moved->red;
+
+    ASSERT(node != nil);
+    if (node->left == nil) {
+	child = node->right;
+	Transplant(node, child);
+    } else if (node->right == nil) {
+	child = node->left;
+	Transplant(node, child);
+    } else {
+	moved = Minimum(node->right);
+	movedWasRed = moved->red;
+	child = moved->right;
+	if (moved->parent == node) {
+	    child->parent = moved;
+	} else {
+	    Transplant(moved, child);
+	    moved->right = node->right;
+	    moved->right->parent = moved;
+	}
+	Transplant(node, moved);
+	moved->left = node->left;
+	moved->left->parent = moved;
+	moved->red = node->red;
+    }
+    if (!movedWasRed)
+	DeleteFixup(child);
+
+    if (node == leftmost)
+	leftmost = (root == nil) ? nil : Minimum(root);
+    delete node;
+    numInTree--;
+}
+
+template <class T>
+void
+RBTree<T>::DeleteFixup(RBNode<T> *node)
+{
+    while (node != root && !node->red) {
+	RBNode<T> *parent = node->parent;
+
+	if (node == parent->left) {
+	    RBNode<T> *sibling = parent->right;
+
+	    if (sibling->red) {
+		sibling->red = FALSE;
+		parent->red = TRUE;
+		RotateLeft(parent);
+		sibling = parent->right;
+	    }
+	    if (!sibling->left->red && !sibling->right->red) {
+		sibling->red = TRUE;
+		node = parent;
+	    } else {
+		if (!sibling->right->red) {
+		    sibling->left->red = FALSE;
+		    sibling->red = TRUE;
+		    RotateRight(sibling);
+		    sibling = parent->right;
+		}
+		sibling->red = parent->red;
+		parent->red = FALSE;
+		sibling->right->red = FALSE;
+		RotateLeft(parent);
+		node = root;
+	    }
+	} else {
+	    RBNode<T> *sibling = parent->left;
+
+	    if (sibling->red) {
+		sibling->red = FALSE;
+		parent->red = TRUE;
+		RotateRight(parent);
+		sibling = parent->left;
+	    }
+	    if (!sibling->left->red && !sibling->right->red) {
+		sibling->red = TRUE;
+		node = parent;
+	    } else {
+		if (!sibling->left->red) {
+		    sibling->right->red = FALSE;
+		    sibling->red = TRUE;
+		    RotateLeft(sibling);
+		    sibling = parent->left;
+		}
+		sibling->red = parent->red;
+		parent->red = FALSE;
+		sibling->left->red = FALSE;
+		RotateRight(parent);
+		node = root;
+	    }
+	}
+    }
+    node->red = FALSE;
+}
+
+//----------------------------------------------------------------------
+// RBTree<T>::RemoveMin
+//	Take the smallest item out of the tree, and return it.
+//	The tree must not be empty.
+//----------------------------------------------------------------------
+
+template <class T>
+T
+RBTree<T>::RemoveMin()
+{
+    T item = Min();
+
+    Remove(item);
+    return item;
+}
+
+//----------------------------------------------------------------------
+// RBTree<T>::SanityCheck
+//	Is this still a legal red-black tree?  The items must be in
+//	order, the root black, no red node may have a red child, and
+//	every path down must pass through the same number of black
+//	nodes.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+RBTree<T>::SanityCheck() const
+{
+    int count = 0;
+
+    ASSERT(!nil->red && !root->red);
+    ASSERT(root == nil || root->parent == nil);
+    (void) CheckSubtree(root, &count);
+    ASSERT(count == numInTree);
+    if (root == nil) {
+	ASSERT(leftmost == nil);
+    } else {
+	ASSERT(leftmost->left == nil);
+	for (RBNode<T> *node = leftmost; node != root; node = node->parent)
+	    ASSERT(node == node->parent->left);
+    }
+}
+
+template <class T>
+int
+RBTree<T>::CheckSubtree(RBNode<T> *node, int *count) const
+{
+    int height;
+
+    if (node == nil)
+	return 1;
+    (*count)++;
+    if (node->left != nil) {
+	ASSERT(node->left->parent == node);
+	ASSERT(compare(node->left->item, node->item) < 0);
+    }
+    if (node->right != nil) {
+	ASSERT(node->right->parent == node);
+	ASSERT(compare(node->item, node->right->item) < 0);
+    }
+    ASSERT(!node->red || (!node->left->red && !node->right->red));
+    height = CheckSubtree(node->left, count);
+    ASSERT(height == CheckSubtree(node->right, count));
+    return height + (node->red ? 0 : 1);
+}
+
+//----------------------------------------------------------------------
+// RBTree<T>::SelfTest
+//	Test whether this module is working: put the items in, take one
+//	out of the middle, then check the rest come out smallest first.
+//	The items must all be different.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+RBTree<T>::SelfTest(T *p, int numEntries)
+{
+    int i;
+    T removed, last;
+
+    ASSERT(IsEmpty());
+    for (i = 0; i < numEntries; i++) {
+	Insert(p[i]);
+	SanityCheck();
+    }
+    ASSERT(NumInTree() == numEntries);
+    for (i = 0; i < numEntries; i++)
+	ASSERT(compare(Min(), p[i]) <= 0);
+
+    removed = p[numEntries / 2];
+    Remove(removed);
+    SanityCheck();
+    last = RemoveMin();
+    for (i = 2; i < numEntries; i++) {
+	T next = RemoveMin();
+
+	ASSERT(compare(last, next) < 0);
+	SanityCheck();
+	last = next;
+    }
+    ASSERT(IsEmpty());
+
+    Insert(removed);		// and back to empty
+    ASSERT(RemoveMin() == removed);
+    SanityCheck();
+}
@@ -0,0 +1,97 @@
+// rbtree.h
+//	Data structures to manage a sorted set of items, kept as a
+//	red-black tree: items can be put in, found or taken out in time
+//	logarithmic in the number of items, and the smallest item is
+//	always at hand.
+//
+//	Items are ordered by a comparison function, as for SortedList,
+//	but unlike a SortedList, no two items in the tree may compare
+//	equal -- that is how an item is found again to take it out.
+//	Callers that want FIFO order among otherwise equal items should
+//	break ties in the comparison function (with a sequence number,
+//	say).  An item's key must not change while it is in the tree.
+//
+//	Allocation and deallocation of the items in the tree are to be
+//	done by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef RBTREE_H
+#define RBTREE_H
+
+#include "copyright.h"
+#include "debug.h"
+
+// The following class defines a "tree node" -- which is used to
+// keep track of one item in the tree.  It is only used internally.
+
+template <class T>
+class RBNode {
+  public:
+    RBNode(T itm) { item = itm; }
+
+    T item;			// the item in the tree
+    bool red;			// red or black
+    RBNode *left, *right;	// smaller and larger items
+    RBNode *parent;		// NIL if this is the root
+};
+
+// The following class defines a "red-black tree" -- a binary search
+// tree kept balanced by giving every node a color: a red node has only
+// black children, and every path from the root to a leaf passes
+// through the same number of black nodes.  So no path is more than
+// twice as long as any other.
+
+template <class T>
+class RBTree {
+  public:
+    RBTree(int (*comp)(T x, T y));
+				// initialize an empty tree
+    ~RBTree();			// de-allocate the tree
+
+    void Insert(T item);	// Put item into the tree
+    void Remove(T item);	// Take item out of the tree; it must
+				// be there
+    T Min() { ASSERT(numInTree > 0); return leftmost->item; }
+				// Return the smallest item, without
+				// removing it
+    T RemoveMin();		// Take the smallest item out of the tree
+
+    int NumInTree() { return numInTree; }
+    bool IsEmpty() { return numInTree == 0; }
+
+    void SanityCheck() const;	// is this still a legal red-black tree?
+    void SelfTest(T *p, int numEntries);
+				// verify module is working
+
+  private:
+    RBNode<T> *root;		// NIL if the tree is empty
+    RBNode<T> *leftmost;	// the node with the smallest item
+    RBNode<T> *nil;		// stands for every missing child: it
+				// is black, and saves checking for NULL
+    int numInTree;		// how many items there are
+
+    int (*compare)(T x, T y);	// function for ordering items
+
+    RBNode<T> *Find(T item);	// the node holding item, or nil
+    RBNode<T> *Minimum(RBNode<T> *node);
+				// the smallest node in a subtree
+    void RotateLeft(RBNode<T> *node);
+    void RotateRight(RBNode<T> *node);
+    void Transplant(RBNode<T> *old, RBNode<T> *node);
+				// put node where old was
+    void InsertFixup(RBNode<T> *node);
+    void DeleteFixup(RBNode<T> *node);
+				// restore the colors after a change
+    void DeleteSubtree(RBNode<T> *node);
+    int CheckSubtree(RBNode<T> *node, int *count) const;
+				// check a subtree, and return its
+				// black height
+};
+
+#include "rbtree.cc"		// templates are really like macros
+				// so needs to be included in every
+				// file that uses the template
+#endif // RBTREE_H
@@ -40,10 +40,7 @@
 #include <fcntl.h>
 #endif
 
-#ifdef LINUX	 // at this point, linux doesn't support mprotect 
-#define NO_MPROT     
-#endif
-#ifdef DOS	// neither does DOS
+#ifdef DOS	// DOS doesn't support mprotect
 #define NO_MPROT
 #endif
 
@@ -51,9 +48,7 @@ extern "C" {
 #include <signal.h>
 #include <sys/types.h>
 
-#ifndef NO_MPROT 
-#include <sys/mman.h>
-#endif
+#include <sys/mman.h>		// for mmap, and mprotect if we have it
 
 // UNIX routines called by procedures in this file 
 
@@ -70,7 +65,7 @@ unsigned sleep(unsigned);
 //#endif
 
 
-#ifndef NO_MPROT	
+#if !defined(NO_MPROT) && !defined(LINUX)	// <sys/mman.h> has it on Linux
 
 #ifdef OSF
 #define OSF_OR_AIX
@@ -201,6 +196,14 @@ RandomNumber()
 //	the end of the array.  Particularly useful for catching overflow
 //	beyond fixed-size thread execution stacks.
 //
+//	The array is mapped straight from the host, on page boundaries,
+//	so the guard pages can be protected; and, where the host allows,
+//	without reserving swap for it (MAP_NORESERVE), so that only the
+//	pages actually touched take up memory.  The array is rounded up
+//	to whole pages, so the guard page after it may not come right
+//	at its end; the one before it (where a stack overflows into)
+//	always does.
+//
 //	Note: Just return the useful part!
 //
 //	"size" -- amount of useful space needed (in bytes)
@@ -213,17 +216,29 @@ AllocBoundedArray(int size)
     return new char[size];
 #else
     int pgSize = getpagesize();
-    char *ptr = new char[pgSize * 2 + size];
+    int length = divRoundUp(size, pgSize) * pgSize;
+    int flags = MAP_PRIVATE | MAP_ANON;
+    char *ptr;
 
-    mprotect(ptr, pgSize, 0);
-    mprotect(ptr + pgSize + size, pgSize, 0);
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif
+    ptr = (char *) mmap(NULL, pgSize * 2 + length, PROT_READ | PROT_WRITE,
+			flags, -1, 0);
+    if (ptr == (char *) MAP_FAILED) {
+	cerr << "Can't map a bounded array of " << size << " bytes\n";
+	Abort();
+    }
+    mprotect(ptr, pgSize, PROT_NONE);
+    mprotect(ptr + pgSize + length, pgSize, PROT_NONE);
     return ptr + pgSize;
 #endif
 }
 
 //----------------------------------------------------------------------
 // DeallocBoundedArray
-// 	Deallocate an array of integers, unprotecting its two boundary pages.
+// 	Deallocate an array from AllocBoundedArray, and its two
+//	boundary pages.
 //
 //	"ptr" -- the array to be deallocated
 //	"size" -- amount of useful space in the array (in bytes)
@@ -241,12 +256,66 @@ DeallocBoundedArray(char *ptr, int size)
 {
     int pgSize = getpagesize();
 
-    mprotect(ptr - pgSize, pgSize, PROT_READ | PROT_WRITE | PROT_EXEC);
-    mprotect(ptr + size, pgSize, PROT_READ | PROT_WRITE | PROT_EXEC);
-    delete [] (ptr - pgSize);
+    munmap(ptr - pgSize, pgSize * 2 + divRoundUp(size, pgSize) * pgSize);
 }
 #endif
 
+//----------------------------------------------------------------------
+// AllocZeroedArray
+// 	Return an array of zeroes, mapped straight from the host's
+//	virtual memory.  Nothing is zeroed (or even allocated) up front:
+//	the host hands out zeroed pages as they are first touched, so a
+//	large array that is mostly left alone costs almost nothing.
+//
+//	If "backingFile" is not NULL, the array lives in that host file
+//	instead of in swap space; the file is created (or truncated) and
+//	grown to "size", which leaves it sparse, and so full of zeroes.
+//
+//	"size" -- amount of space needed (in bytes)
+//	"backingFile" -- host file to keep the array in, or NULL
+//----------------------------------------------------------------------
+
+char *
+AllocZeroedArray(size_t size, char *backingFile)
+{
+    void *ptr;
+
+    if (backingFile == NULL) {
+	ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANON, -1, 0);
+    } else {
+	int fd = OpenForWrite(backingFile);
+
+	if (ftruncate(fd, size) < 0) {
+	    cerr << "Can't grow " << backingFile << " to " << size
+			<< " bytes\n";
+	    Abort();
+	}
+	ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	Close(fd);		// the mapping keeps the file open
+    }
+    if (ptr == MAP_FAILED) {
+	cerr << "Can't map " << size << " bytes of memory\n";
+	Abort();
+    }
+    return (char *) ptr;
+}
+
+//----------------------------------------------------------------------
+// DeallocZeroedArray
+// 	Give an array from AllocZeroedArray back to the host.  If it was
+//	kept in a file, the file is left with the array's final contents.
+//
+//	"ptr" -- the array to be deallocated
+//	"size" -- amount of space in the array (in bytes)
+//----------------------------------------------------------------------
+
+void
+DeallocZeroedArray(char *ptr, size_t size)
+{
+    munmap(ptr, size);
+}
+
 //----------------------------------------------------------------------
 // PollFile
 // 	Check open file or open socket to see if there are any 
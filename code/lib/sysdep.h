@@ -37,6 +37,12 @@ extern unsigned int RandomNumber();
 extern char *AllocBoundedArray(int size);
 extern void DeallocBoundedArray(char *p, int size);
 
+// Allocate, de-allocate a (possibly very large) array of zeroes,
+// whose pages only cost anything once they are used; optionally
+// kept in a host file
+extern char *AllocZeroedArray(size_t size, char *backingFile);
+extern void DeallocZeroedArray(char *p, size_t size);
+
 // Check file to see if there are any characters to be read.
 // If no characters in the file, return without waiting.
 extern bool PollFile(int fd);
@@ -23,21 +23,14 @@
 #include "copyright.h"
 #include "interrupt.h"
 #include "main.h"
+#include <sys/time.h>
 
 // String definitions for debugging messages
 
 static char *intLevelNames[] = { "off", "on"};
-static char *intTypeNames[] = { "timer", "disk", "console write", 
+static const char *intTypeNames[] = { "timer", "disk", "console write", 
 			"console read", "network send", 
-			"network recv"};
-            
-bool cmpL2InInterrupt(Thread *th1, Thread *th2) {
-    return th1->checkPriority() > th2->checkPriority();
-}
-
-bool cmpL1InInterrupt(Thread *th1, Thread *th2) {
-    return th1->checkT() < th2->checkT();
-}
+			"network recv", "workload arrival"};
             
 //----------------------------------------------------------------------
 // PendingInterrupt::PendingInterrupt
@@ -55,11 +48,17 @@ PendingInterrupt::PendingInterrupt(CallBackObj *callOnInt,
     callOnInterrupt = callOnInt;
     when = time;
     type = kind;
+    seq = 0;
+    index = -1;
+    nextFree = NULL;
 }
 
 //----------------------------------------------------------------------
 // PendingCompare
-//	Compare to interrupts based on which should occur first.
+//	Compare to interrupts based on which should occur first: the
+//	earlier, or of two at the same time, the one scheduled first.
+//	The sequence numbers may wrap around, but not between two
+//	interrupts pending at the same time.
 //----------------------------------------------------------------------
 
 static int
@@ -67,9 +66,22 @@ PendingCompare (PendingInterrupt *x, PendingInterrupt *y)
 {
     if (x->when < y->when) { return -1; }
     else if (x->when > y->when) { return 1; }
+    else if (x->seq != y->seq) { return ((int) (x->seq - y->seq) < 0) ? -1 : 1; }
     else { return 0; }
 }
 
+//----------------------------------------------------------------------
+// PendingPlace
+//	Keep track of where an interrupt is in the heap, so it can be
+//	cancelled without a search.
+//----------------------------------------------------------------------
+
+static void
+PendingPlace (PendingInterrupt *x, int index)
+{
+    x->index = index;
+}
+
 //----------------------------------------------------------------------
 // Interrupt::Interrupt
 // 	Initialize the simulation of hardware device interrupts.
@@ -80,7 +92,9 @@ PendingCompare (PendingInterrupt *x, PendingInterrupt *y)
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new SortedList<PendingInterrupt *>(PendingCompare);
+    pending = new Heap<PendingInterrupt *>(PendingCompare, PendingPlace);
+    freeInts = NULL;
+    numScheduled = 0;
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
@@ -94,9 +108,15 @@ Interrupt::Interrupt()
 Interrupt::~Interrupt()
 {
     while (!pending->IsEmpty()) {
-	delete pending->RemoveFront();
+	delete pending->RemoveMin();
     }
     delete pending;
+    while (freeInts != NULL) {
+	PendingInterrupt *next = freeInts->nextFree;
+
+	delete freeInts;
+	freeInts = next;
+    }
 }
 
 //----------------------------------------------------------------------
@@ -176,98 +196,10 @@ Interrupt::OneTick()
                                 // (interrupt handlers run with
                                 // interrupts disabled)
     
-    // handle L1Queue
-    std::list<Thread *> *queue = scheduler->getL1Queue();
-    for (std::list<Thread *>::iterator it = queue->begin(); it != queue->end(); it++) {
-        if (stats->totalTicks - (*it)->checkLastInQueueTick() >= 1500) {
-            // enable scheduling, and update t of currentThread once
-            // kernel->currentThread->setT(kernel->currentThread->checkTempTick() / 2 + kernel->currentThread->checkT() / 2);
-            // scheduler->enablePreemptOnce = true;
-            Thread *temp = (*it);
-            int addedPriority = temp->checkPriority() + 10;
-            if (addedPriority > 149) addedPriority = 149;
-            printf("Tick %d: Thread %d changes its priority from %d to %d\n", stats->totalTicks, temp->getID(), temp->checkPriority(), addedPriority);
-            temp->setPriority(addedPriority);
-            temp->setLastInQueueTick(stats->totalTicks);
-        }
-    }
-    queue->sort(cmpL1InInterrupt);
-    
-    // handle L2Queue
-    queue = scheduler->getL2Queue();
-    for (std::list<Thread *>::iterator it = queue->begin(); it != queue->end(); ) {
-        if (stats->totalTicks - (*it)->checkLastInQueueTick() >= 1500) {
-            Thread *temp = (*it);
-            int addedPriority = temp->checkPriority() + 10;
-            printf("Tick %d: Thread %d changes its priority from %d to %d\n", stats->totalTicks, temp->getID(), temp->checkPriority(), addedPriority);
-            temp->setPriority(addedPriority);
-            temp->setLastInQueueTick(stats->totalTicks);
-            if (temp->checkPriority() >= 100) {
-		// enable scheduling, and update t of currentThread once
-		kernel->currentThread->setT(kernel->currentThread->checkTempTick() / 2 + kernel->currentThread->checkT() / 2);
-		scheduler->enablePreemptOnce = true;
-                it = queue->erase(it);
-                scheduler->getL1Queue()->push_back(temp);
-                printf("Tick %d: Thread %d is removed from queue L2\n", stats->totalTicks, temp->getID());
-                printf("Tick %d: Thread %d is inserted into queue L1\n", stats->totalTicks, temp->getID());
-                scheduler->getL1Queue()->sort(cmpL1InInterrupt);
-            } else it++;
-        } else it++;
-    }
-    queue->sort(cmpL2InInterrupt);
-    
-    // handle L3Queue
-    queue = scheduler->getL3Queue();
-    for (std::list<Thread *>::iterator it = queue->begin(); it != queue->end(); ) {
-        if (stats->totalTicks - (*it)->checkLastInQueueTick() >= 1500) {
-            Thread *temp = (*it);
-            int addedPriority = temp->checkPriority() + 10;
-            printf("Tick %d: Thread %d changes its priority from %d to %d\n", stats->totalTicks, temp->getID(), temp->checkPriority(), addedPriority);
-            temp->setPriority(addedPriority);
-            temp->setLastInQueueTick(stats->totalTicks);
-            if (temp->checkPriority() >= 50) {
-		// enable scheduling, and update t of currentThread once
-		kernel->currentThread->setT(kernel->currentThread->checkTempTick() / 2 + kernel->currentThread->checkT() / 2);
-		scheduler->enablePreemptOnce = true;
-                it = queue->erase(it);
-                scheduler->getL2Queue()->push_back(temp);
-                printf("Tick %d: Thread %d is removed from queue L3\n", stats->totalTicks, temp->getID());
-                printf("Tick %d: Thread %d is inserted into queue L2\n", stats->totalTicks, temp->getID());
-                scheduler->getL2Queue()->sort(cmpL2InInterrupt);
-            } else it++;
-        } else it++;
-    }
-    
-    if (scheduler->enablePreemptOnce) {
-        /*
-        queue = scheduler->getL1Queue();
-        for (std::list<Thread *>::iterator it = queue->begin(); it != queue->end(); it++) {
-            Thread *temp = (*it);
-            printf("Thread: %d t=%d\n", temp->getID(), temp->checkT());
-        }
-        if (kernel->currentThread->getID() == 2)
-            printf("t: %d, executed: %d\n", kernel->currentThread->checkT(), kernel->currentThread->checkTempTick());
-        */
-        Thread *candidate = scheduler->PureFindNext();
-        /*
-        if (candidate != NULL) printf("candidate ID: %d, t: %d\n", candidate->getID(), candidate->checkT());
-        */
-        if (candidate != NULL && kernel->currentThread->checkPriority() != 150) {
-            if (candidate->checkPriority() >= 50 && candidate->checkPriority() < 100) { // if candidate is in L2...
-                if (kernel->currentThread->checkPriority() < 50) yieldOnReturn = true; // L3 is preempted by L2
-                else if (kernel->currentThread->checkPriority() < 100) {
-                    if (candidate->checkPriority() > kernel->currentThread->checkPriority()) yieldOnReturn = true; // both L2, but candidate's priority is higher
-                }
-            } else if (candidate->checkPriority() >= 100 && candidate->checkPriority() < 150) { // if candidate is in L1...
-                if (kernel->currentThread->checkPriority() < 50) yieldOnReturn = true; // L3 is preempted by L1
-                else if (kernel->currentThread->checkPriority() < 100) yieldOnReturn = true; // L2 is preempted by L1
-                else {
-                    if (candidate->checkT() < kernel->currentThread->checkT()) yieldOnReturn = true; // both L1, but candidate's t is smaller
-                }
-            }
-        }
-        scheduler->enablePreemptOnce = false;
-    }
+    scheduler->Tick();		// let the scheduling policy age
+				// threads, and so on
+    if (scheduler->ShouldPreempt())
+        yieldOnReturn = TRUE;	// a ready thread should run instead
     
     CheckIfDue(FALSE);		    // check for pending interrupts
     ChangeLevel(IntOff, IntOn);	// re-enable interrupts
@@ -282,6 +214,62 @@ Interrupt::OneTick()
     }
 }
 
+//----------------------------------------------------------------------
+// Interrupt::QuietTicks
+// 	Return the number of user instructions that can be executed, 
+//	from now, before a call to OneTick would do anything except
+//	advance the clock.  Used by the machine emulation to batch up 
+//	user ticks (see Machine::Run).
+//
+//	OneTick has real work to do when a pending interrupt comes due,
+//	when the scheduling policy has something to do (a ready thread
+//	is due for aging, or a preemption check has been asked for), or
+//	when a context switch has been asked for.  Nothing else can change
+//	any of those while the user program is only executing 
+//	instructions; a system call or other exception has to go through
+//	OneTick before we are asked again.
+//----------------------------------------------------------------------
+
+int
+Interrupt::QuietTicks()
+{
+    int now = kernel->stats->totalTicks;
+    int next;			// first tick with something to do
+
+    if (yieldOnReturn)
+	return 0;
+    next = kernel->scheduler->NextEventTick();
+    if (!pending->IsEmpty()) {
+	int when = pending->Min()->when;
+	if (next < 0 || when < next)
+	    next = when;
+    }
+    if (next < 0)		// nothing will ever happen
+	return (1 << 30) / UserTick;
+    if (next <= now + UserTick)
+	return 0;
+    return (next - now - 1) / UserTick;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::AdvanceUserTicks
+// 	Account for "count" user instructions in one go, exactly as
+//	"count" calls to OneTick would have, given that QuietTicks said
+//	there was nothing else for them to do.
+//----------------------------------------------------------------------
+
+void
+Interrupt::AdvanceUserTicks(int count)
+{
+    Statistics *stats = kernel->stats;
+    Thread *thread = kernel->currentThread;
+
+    ASSERT(status == UserMode);
+    stats->totalTicks += count * UserTick;
+    stats->userTicks += count * UserTick;
+    thread->setTempTick(thread->checkTempTick() + count * UserTick);
+}
+
 //----------------------------------------------------------------------
 // Interrupt::YieldOnReturn
 // 	Called from within an interrupt handler, to cause a context switch
@@ -343,6 +331,8 @@ Interrupt::Halt()
     cout << "Machine halting!\n\n";
     cout << "This is halt\n";
     kernel->stats->Print();
+    if (kernel->lockProfile != NULL)
+	kernel->lockProfile->Print();
     delete kernel;	// Never returns.
 }
 
@@ -378,26 +368,61 @@ Interrupt::CreateFile(char *filename)
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: just put it in the heap, in a record kept from
+//	an earlier interrupt if there is one.
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
 //
+//	Returns the pending interrupt, for Cancel.  It is only good until
+//	the interrupt occurs (or is cancelled): after that, the record is
+//	reused.
+//
 //	"toCall" is the object to call when the interrupt occurs
 //	"fromNow" is how far in the future (in simulated time) the 
 //		 interrupt is to occur
 //	"type" is the hardware device that generated the interrupt
 //----------------------------------------------------------------------
-void
+PendingInterrupt *
 Interrupt::Schedule(CallBackObj *toCall, int fromNow, IntType type)
 {
     int when = kernel->stats->totalTicks + fromNow;
-    PendingInterrupt *toOccur = new PendingInterrupt(toCall, when, type);
+    PendingInterrupt *toOccur;
 
     DEBUG(dbgInt, "Scheduling interrupt handler the " << intTypeNames[type] << " at time = " << when);
     ASSERT(fromNow > 0);
 
+    if (freeInts != NULL) {
+	toOccur = freeInts;
+	freeInts = toOccur->nextFree;
+	toOccur->callOnInterrupt = toCall;
+	toOccur->when = when;
+	toOccur->type = type;
+    } else {
+	toOccur = new PendingInterrupt(toCall, when, type);
+    }
+    toOccur->seq = numScheduled++;
     pending->Insert(toOccur);
+    return toOccur;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::Cancel
+// 	Take back an interrupt that was scheduled, so that it never
+//	occurs.  It must still be pending: a device that cancels its
+//	interrupts has to forget each one when it occurs.
+//
+//	"toCancel" is the interrupt, as returned by Schedule
+//----------------------------------------------------------------------
+void
+Interrupt::Cancel(PendingInterrupt *toCancel)
+{
+    ASSERT(toCancel->index >= 0);	// still pending
+    DEBUG(dbgInt, "Cancelling interrupt handler the " << intTypeNames[toCancel->type] << " at time = " << toCancel->when);
+
+    (void) pending->Remove(toCancel->index);
+    toCancel->nextFree = freeInts;
+    freeInts = toCancel;
 }
 
 //----------------------------------------------------------------------
@@ -426,7 +451,7 @@ Interrupt::CheckIfDue(bool advanceClock)
     if (pending->IsEmpty()) {   	// no pending interrupts
 	return FALSE;	
     }		
-    next = pending->Front();
+    next = pending->Min();
 
     if (next->when > stats->totalTicks) {
         if (!advanceClock) {		// not time yet
@@ -448,11 +473,15 @@ Interrupt::CheckIfDue(bool advanceClock)
 
     inHandler = TRUE;
     do {
-        next = pending->RemoveFront();    // pull interrupt off list
-        next->callOnInterrupt->CallBack();// call the interrupt handler
-	delete next;
+	CallBackObj *toCall;
+
+        next = pending->RemoveMin();	// pull interrupt off the heap
+	toCall = next->callOnInterrupt;
+	next->nextFree = freeInts;	// the handler may reuse the record
+	freeInts = next;
+        toCall->CallBack();		// call the interrupt handler
     } while (!pending->IsEmpty() 
-    		&& (pending->Front()->when <= stats->totalTicks));
+    		&& (pending->Min()->when <= stats->totalTicks));
     inHandler = FALSE;
     return TRUE;
 }
@@ -473,16 +502,138 @@ PrintPending (PendingInterrupt *pending)
 //----------------------------------------------------------------------
 // DumpState
 // 	Print the complete interrupt state - the status, and all interrupts
-//	that are scheduled to occur in the future.
+//	that are scheduled to occur in the future, in the order they
+//	will occur (the heap is copied and emptied, to sort them).
 //----------------------------------------------------------------------
 
 void
 Interrupt::DumpState()
 {
+    Heap<PendingInterrupt *> sorted(PendingCompare);
+
     cout << "Time: " << kernel->stats->totalTicks;
     cout << ", interrupts " << intLevelNames[level] << "\n";
     cout << "Pending interrupts:\n";
-    pending->Apply(PrintPending);
+    for (int i = 0; i < pending->NumInHeap(); i++)
+	sorted.Insert(pending->Item(i));
+    while (!sorted.IsEmpty())
+	PrintPending(sorted.RemoveMin());
     cout << "\nEnd of pending interrupts\n";
 }
 
+// A device for testing the pending interrupts.  Each interrupt it gets
+// is counted, and noted in a log if there is one; for the benchmark,
+// it schedules its next interrupt, a random time ahead.
+
+class TestDevice : public CallBackObj {
+  public:
+    Interrupt *interrupt;	// the interrupts it is testing
+    int id;			// what it writes in the log
+    int *log;			// the devices, in the order their
+    int *numCalls;		// interrupts occurred
+    bool again;			// schedule another after each?
+
+    void CallBack() {
+	if (log != NULL)
+	    log[*numCalls] = id;
+	(*numCalls)++;
+	if (again)
+	    interrupt->Schedule(this, 1 + RandomNumber() % 1000, TimerInt);
+    }
+};
+
+//----------------------------------------------------------------------
+// Interrupt::SelfTest
+// 	Test whether the pending interrupts are working: they occur in
+//	order of time and then of scheduling, a cancelled one doesn't
+//	occur, and a record is reused once its interrupt has occurred.
+//
+//	Must be called on an interrupt simulation of its own, with no
+//	interrupts pending.  The simulated time is left as it was.
+//----------------------------------------------------------------------
+
+void
+Interrupt::SelfTest()
+{
+    static int whens[] = { 10, 5, 10, 10, 20 };
+    const int numDevices = sizeof(whens) / sizeof(int);
+    Statistics *stats = kernel->stats;
+    int savedTicks = stats->totalTicks, savedIdle = stats->idleTicks;
+    TestDevice devices[numDevices];
+    PendingInterrupt *toOccur[numDevices], *reused;
+    int log[numDevices], numCalls = 0;
+    int i;
+
+    ASSERT(pending->IsEmpty() && level == IntOff);
+    for (i = 0; i < numDevices; i++) {
+	devices[i].interrupt = this;
+	devices[i].id = i;
+	devices[i].log = log;
+	devices[i].numCalls = &numCalls;
+	devices[i].again = FALSE;
+	toOccur[i] = Schedule(&devices[i], whens[i], TimerInt);
+    }
+    Cancel(toOccur[2]);			// from the middle of the heap
+
+    (void) CheckIfDue(TRUE);		// 5 ticks on: just 1
+    ASSERT(numCalls == 1 && log[0] == 1);
+    ASSERT(stats->totalTicks == savedTicks + 5);
+    (void) CheckIfDue(TRUE);		// 10: 0 then 3, as scheduled
+    ASSERT(numCalls == 3 && log[1] == 0 && log[2] == 3);
+
+    reused = Schedule(&devices[2], 5, TimerInt);
+    ASSERT(reused == toOccur[3]);	// the last record freed
+    Cancel(reused);
+    (void) CheckIfDue(TRUE);		// 20: 4
+    ASSERT(numCalls == 4 && log[3] == 4);
+    ASSERT(pending->IsEmpty());
+
+    stats->totalTicks = savedTicks;
+    stats->idleTicks = savedIdle;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::Benchmark
+// 	Time the pending interrupts, with "numPending" devices each
+//	keeping an interrupt pending, until "numEvents" interrupts have
+//	occurred.  Returns the host time per interrupt, in nanoseconds:
+//	taking it off the heap, and scheduling the next.
+//
+//	Must be called on an interrupt simulation of its own, with no
+//	interrupts pending.  The simulated time is left as it was.
+//----------------------------------------------------------------------
+
+double
+Interrupt::Benchmark(int numPending, int numEvents)
+{
+    Statistics *stats = kernel->stats;
+    int savedTicks = stats->totalTicks, savedIdle = stats->idleTicks;
+    TestDevice *devices = new TestDevice[numPending];
+    struct timeval start, end;
+    int i, numCalls = 0;
+
+    ASSERT(pending->IsEmpty() && level == IntOff);
+    for (i = 0; i < numPending; i++) {
+	devices[i].interrupt = this;
+	devices[i].id = i;
+	devices[i].log = NULL;
+	devices[i].numCalls = &numCalls;
+	devices[i].again = TRUE;
+	(void) Schedule(&devices[i], 1 + RandomNumber() % 1000, TimerInt);
+    }
+
+    gettimeofday(&start, NULL);
+    while (numCalls < numEvents)
+	(void) CheckIfDue(TRUE);
+    gettimeofday(&end, NULL);
+
+    while (!pending->IsEmpty())
+	Cancel(pending->Min());
+    delete [] devices;
+    stats->totalTicks = savedTicks;
+    stats->idleTicks = savedIdle;
+
+    double usecs = (end.tv_sec - start.tv_sec) * 1e6
+			+ (end.tv_usec - start.tv_usec);
+    return usecs * 1000 / numCalls;
+}
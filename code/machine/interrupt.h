@@ -24,6 +24,12 @@
 //	fine on this hardware simulation (even with randomized time slices),
 //	but it wouldn't work on real hardware.
 //
+//	The interrupts scheduled to occur are kept in a binary heap, so
+//	scheduling one, or taking the next one off, takes time logarithmic
+//	in the number pending.  Interrupts scheduled for the same time
+//	occur in the order they were scheduled.  The PendingInterrupt
+//	records are kept for reuse, rather than deleted, once they occur.
+//
 //  DO NOT CHANGE -- part of the machine emulation
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
@@ -34,7 +40,7 @@
 #define INTERRUPT_H
 
 #include "copyright.h"
-#include "list.h"
+#include "heap.h"
 #include "callback.h"
 
 // Interrupts can be disabled (IntOff) or enabled (IntOn)
@@ -47,9 +53,10 @@ enum MachineStatus {IdleMode, SystemMode, UserMode};
 
 // IntType records which hardware device generated an interrupt.
 // In Nachos, we support a hardware timer device, a disk, a console
-// display and keyboard, and a network.
+// display and keyboard, and a network -- and the arrival of a job of
+// the workload (see threads/workload.h), as if a user had typed it in.
 enum IntType { TimerInt, DiskInt, ConsoleWriteInt, ConsoleReadInt, 
-			NetworkSendInt, NetworkRecvInt};
+			NetworkSendInt, NetworkRecvInt, WorkloadInt};
 
 // The following class defines an interrupt that is scheduled
 // to occur in the future.  The internal data structures are
@@ -66,6 +73,13 @@ class PendingInterrupt {
     
     int when;			// When the interrupt is supposed to fire
     IntType type;		// for debugging
+
+    unsigned int seq;		// order it was scheduled in, among
+				// those at the same time
+    int index;			// where it is in the heap of pending
+				// interrupts, -1 if it isn't pending
+    PendingInterrupt *nextFree;	// next record kept for reuse, if it
+				// isn't pending
 };
 
 // The following class defines the data structures for the simulation
@@ -121,18 +135,38 @@ class Interrupt {
     // but they need to be public since they are called by the
     // hardware device simulators.
 
-    void Schedule(CallBackObj *callTo, int when, IntType type);
+    PendingInterrupt *Schedule(CallBackObj *callTo, int when, IntType type);
     				// Schedule an interrupt to occur
 				// at time "when".  This is called
     				// by the hardware device simulators.
+    void Cancel(PendingInterrupt *toCancel);
+				// Take back an interrupt that has been
+				// scheduled and hasn't occurred yet
     
     void OneTick();       	// Advance simulated time
 
+    int QuietTicks();		// How many user instructions can run
+				// before OneTick has anything to do but
+				// advance the clock
+    void AdvanceUserTicks(int count);
+				// Advance the clock by "count" user
+				// instructions' worth of ticks, without
+				// checking for anything else
+
+    void SelfTest();		// test the pending interrupts, on an
+				// interrupt simulation of its own
+    double Benchmark(int numPending, int numEvents);
+				// time the pending interrupts (ditto)
+
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    SortedList<PendingInterrupt *> *pending;		
-    				// the list of interrupts scheduled
-				// to occur in the future
+    Heap<PendingInterrupt *> *pending;
+    				// the interrupts scheduled to occur
+				// in the future, soonest first
+    PendingInterrupt *freeInts;	// records kept for reuse
+    unsigned int numScheduled;	// how many interrupts have been
+				// scheduled, to order those at the
+				// same time
     //int writeFileNo;            //UNIX file emulating the display
     bool inHandler;		// TRUE if we are running an interrupt handler
     //bool putBusy;               // Is a PrintInt operation in progress
@@ -44,34 +44,94 @@ void CheckEndian()
 #endif
 }
 
+//----------------------------------------------------------------------
+// Machine::MaxPhysPages
+// 	Return the most pages of physical memory a machine can have.
+//	The byte address of every word must fit in an int; and for each
+//	byte of memory, the host must also map a third of an Instruction
+//	(and, with "threaded", a quarter of a handler address) in the
+//	caches that have an entry per word.  On a 32-bit host, all of
+//	them together must fit in half of its address space.
+//----------------------------------------------------------------------
+
+int
+Machine::MaxPhysPages(bool threaded)
+{
+    double bytesPerPage = PageSize
+	+ (double) (PageSize / 4) * sizeof(Instruction)
+	+ (threaded ? (double) (PageSize / 4) * sizeof(void *) : 0);
+    double hostPages = (sizeof(void *) < 8) ? 2147483648.0 / bytesPerPage
+					      : 1e18;
+
+    return (int) min((double) ((1 << 30) / PageSize), hostPages);
+}
+
 //----------------------------------------------------------------------
 // Machine::Machine
 // 	Initialize the simulation of user program execution.
 //
 //	"debug" -- if TRUE, drop into the debugger after each user instruction
 //		is executed.
+//	"threaded" -- if TRUE, run user programs with the threaded-code
+//		engine (see Machine::RunThreaded)
+//	"batched" -- if TRUE, advance the clock in bulk between the ticks
+//		that have something to do (see Machine::Run)
+//	"tlbEntries", "tlbAssoc" -- the size and associativity of the TLB,
+//		if we are using one.  tlbAssoc == tlbEntries makes it
+//		fully associative.
+//	"physPages" -- how many pages of physical memory there are
+//	"memoryFile" -- if not NULL, a host file to keep physical memory in
+//
+//	Physical memory, and the caches that have an entry per word of
+//	it, are mapped from the host zeroed but untouched, so a machine
+//	with hundreds of megabytes starts as fast as a small one, and
+//	only the pages that get used take up host memory.  (An all-zero
+//	Instruction is "not decoded yet", and an all-zero handler
+//	address is NULL, so they need no initialization either.)
 //----------------------------------------------------------------------
 
-Machine::Machine(bool debug)
+Machine::Machine(bool debug, bool threaded, bool batched, int tlbEntries,
+		 int tlbAssoc, int physPages, char *memoryFile)
 {
     int i;
 
     for (i = 0; i < NumTotalRegs; i++)
         registers[i] = 0;
-    mainMemory = new char[MemorySize];
-    for (i = 0; i < MemorySize; i++)
-      	mainMemory[i] = 0;
+    ASSERT(physPages > 0 && physPages <= MaxPhysPages(threaded));
+    numPhysPages = physPages;
+    memorySize = numPhysPages * PageSize;
+    mainMemory = AllocZeroedArray(memorySize, memoryFile);
+    decodeCache = (Instruction *) AllocZeroedArray(
+			(size_t) (memorySize / 4) * sizeof(Instruction), NULL);
+    decodedPage = new bool[numPhysPages];
+    for (i = 0; i < numPhysPages; i++)
+	decodedPage[i] = FALSE;
+    threadedCode = NULL;
+    if (threaded)
+	threadedCode = (void **) AllocZeroedArray(
+			(size_t) (memorySize / 4) * sizeof(void *), NULL);
 #ifdef USE_TLB
-    tlb = new TranslationEntry[TLBSize];
-    for (i = 0; i < TLBSize; i++)
+    ASSERT(tlbEntries > 0 && tlbAssoc > 0 && tlbEntries % tlbAssoc == 0);
+    tlbSize = tlbEntries;
+    tlbWays = tlbAssoc;
+    tlb = new TranslationEntry[tlbSize];
+    for (i = 0; i < tlbSize; i++)
 	tlb[i].valid = FALSE;
     pageTable = NULL;
 #else	// use linear page table
+    tlbSize = tlbWays = 0;
     tlb = NULL;
     pageTable = NULL;
 #endif
+    // Every access has to go through Translate if we're tracing them,
+    // or if the TLB is counting its hits.
+    hostTLBEnabled = !::debug->IsEnabled(dbgAddr) && tlb == NULL;
+    FlushHostTLB();
 
     singleStep = debug;
+    batchTicks = batched;
+    owedTicks = 0;
+    numTraps = 0;
     CheckEndian();
 }
 
@@ -82,7 +142,13 @@ Machine::Machine(bool debug)
 
 Machine::~Machine()
 {
-    delete [] mainMemory;
+    DeallocZeroedArray(mainMemory, memorySize);
+    DeallocZeroedArray((char *) decodeCache,
+			(size_t) (memorySize / 4) * sizeof(Instruction));
+    delete [] decodedPage;
+    if (threadedCode != NULL)
+	DeallocZeroedArray((char *) threadedCode,
+			(size_t) (memorySize / 4) * sizeof(void *));
     if (tlb != NULL)
         delete [] tlb;
 }
@@ -101,6 +167,8 @@ void
 Machine::RaiseException(ExceptionType which, int badVAddr)
 {
     DEBUG(dbgMach, "Exception: " << exceptionNames[which]);
+    SettleTicks();			// the kernel may look at the clock
+    numTraps++;
     registers[BadVAddrReg] = badVAddr;
     DelayedLoad(0, 0);			// finish anything in progress
     kernel->interrupt->setStatus(SystemMode);
@@ -108,6 +176,23 @@ Machine::RaiseException(ExceptionType which, int badVAddr)
     kernel->interrupt->setStatus(UserMode);
 }
 
+//----------------------------------------------------------------------
+// Machine::SettleTicks
+// 	In batched mode, Run doesn't call OneTick after instructions 
+//	that Interrupt::QuietTicks told it had nothing else to do; it just
+//	counts them.  Put that count on the simulated clock now, because
+//	somebody is about to look at it.
+//----------------------------------------------------------------------
+
+void
+Machine::SettleTicks()
+{
+    if (owedTicks > 0) {
+	kernel->interrupt->AdvanceUserTicks(owedTicks);
+	owedTicks = 0;
+    }
+}
+
 //----------------------------------------------------------------------
 // Machine::Debugger
 // 	Primitive debugger for user programs.  Note that we can't use
@@ -31,14 +31,15 @@ const int PageSize = 128; 		// set the page size equal to
 					// the disk sector size, for simplicity
 
 //
-// You are allowed to change this value.
-// Doing so will change the number of pages of physical memory
-// available on the simulated machine.
+// The number of pages of physical memory on the simulated machine,
+// unless the -mem flag says otherwise (see Machine::numPhysPages).
 //
 const int NumPhysPages = 128;
 
-const int MemorySize = (NumPhysPages * PageSize);
 const int TLBSize = 4;			// if there is a TLB, make it small
+					// (the default; see Machine::Machine)
+const int HostTLBSize = 64;		// entries in the simulator's cache of
+					// translations; a power of two
 
 enum ExceptionType { NoException,           // Everything ok!
 		     SyscallException,      // A program executed a system call.
@@ -88,15 +89,41 @@ enum ExceptionType { NoException,           // Everything ok!
 // The procedures in this class are defined in machine.cc, mipssim.cc, and
 // translate.cc.
 
-class Instruction;
 class Interrupt;
 
+// The following class defines an instruction, represented in both
+// 	undecoded binary form
+//      decoded to identify
+//	    operation to do
+//	    registers to act on
+//	    any immediate operand value
+
+class Instruction {
+  public:
+    void Decode();	// decode the binary representation of the instruction
+
+    unsigned int value; // binary representation of the instruction
+
+    char opCode;     // Type of instruction.  This is NOT the same as the
+    		     // opcode field from the instruction: see defs in mips.h
+		     // Zero means "not decoded yet" (see decodeCache).
+    char rs, rt, rd; // Three registers from instruction.
+    int extra;       // Immediate or target or shamt field or offset.
+                     // Immediates are sign-extended.
+};
+
 class Machine {
   public:
-    Machine(bool debug);	// Initialize the simulation of the hardware
+    Machine(bool debug, bool threaded, bool batched, int tlbEntries,
+	    int tlbAssoc, int physPages, char *memoryFile);
+				// Initialize the simulation of the hardware
 				// for running user programs
     ~Machine();			// De-allocate the data structures
 
+    static int MaxPhysPages(bool threaded);
+				// the most pages of physical memory whose
+				// arrays the host can map
+
 // Routines callable by the Nachos kernel
     void Run();	 		// Run a user program
 
@@ -113,6 +140,8 @@ class Machine {
 
     char *mainMemory;		// physical memory to store user program,
 				// code and data, while executing
+    int numPhysPages;		// how many pages of it there are
+    int memorySize;		// and how many bytes
 
 // NOTE: the hardware translation of virtual addresses in the user program
 // to physical addresses (relative to the beginning of "mainMemory")
@@ -134,6 +163,12 @@ class Machine {
 
     TranslationEntry *tlb;		// this pointer should be considered 
 					// "read-only" to Nachos kernel code
+    int tlbSize;			// number of entries in the TLB
+    int tlbWays;			// entries per set: a virtual page
+					// can only go in set 
+					// (vpn % (tlbSize / tlbWays)), which
+					// is tlb[set * tlbWays] onwards.
+					// Also read-only to the kernel.
 
     TranslationEntry *pageTable;
     unsigned int pageTableSize;
@@ -143,14 +178,35 @@ class Machine {
     				// Read or write 1, 2, or 4 bytes of virtual 
 				// memory (at addr).  Return FALSE if a 
 				// correct translation couldn't be found.
+
+    void InvalidateDecodeCache(int physPage);
+				// Forget the pre-decoded instructions of a
+				// physical page.  WriteMem does this for us;
+				// kernel code that writes mainMemory directly
+				// (e.g., when loading a program) must call it.
+
+    void FlushHostTLB();	// Forget the translations cached by ReadMem
+				// and WriteMem.  The kernel must call this
+				// whenever it changes the page table (or
+				// the TLB) under the running program, or
+				// clears a use or dirty bit in it.
   private:
 
 // Routines internal to the machine simulation -- DO NOT call these directly
     void DelayedLoad(int nextReg, int nextVal);  	
 				// Do a pending delayed load (modifying a reg)
 
-    void OneInstruction(Instruction *instr); 	
-    				// Run one instruction of a user program.
+    void OneInstruction(); 	// Run one instruction of a user program.
+
+    Instruction *FetchInstruction();
+				// Translate the PC and return the decoded
+				// instruction there, or NULL on an exception
+
+    void RunThreaded();		// Run a user program with the threaded-code
+				// engine instead of OneInstruction
+
+    void SettleTicks();		// Put the user ticks saved up in batched
+				// mode on the simulated clock
     
 
 
@@ -173,8 +229,30 @@ class Machine {
 
     int registers[NumTotalRegs]; // CPU registers, for executing user programs
 
+    Instruction *decodeCache;	// one decoded instruction per word of 
+				// mainMemory, filled in the first time the
+				// word is executed
+    bool *decodedPage;		// TRUE if a physical page has anything
+				// in decodeCache
+    void **threadedCode;	// handler address for each entry of 
+				// decodeCache, used by RunThreaded; NULL
+				// if running the reference interpreter
+
+    HostTranslation readHostTLB[HostTLBSize];
+    HostTranslation writeHostTLB[HostTLBSize];
+				// direct-mapped caches of pages that have
+				// been read (use bit set) or written (dirty
+				// bit set) since the last FlushHostTLB
+    bool hostTLBEnabled;	// FALSE if every access must be traced
+
     bool singleStep;		// drop back into the debugger after each
 				// simulated instruction
+    bool batchTicks;		// only call OneTick when it has something
+				// to do (see Interrupt::QuietTicks)
+    int owedTicks;		// user instructions executed but not yet
+				// put on the clock, in batched mode
+    int numTraps;		// number of calls to RaiseException, so
+				// Run can tell if an instruction trapped
     int runUntilTime;		// drop back into the debugger when simulated
 				// time reaches this value
 
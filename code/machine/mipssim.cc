@@ -25,26 +25,6 @@
 
 static void Mult(int a, int b, bool signedArith, int* hiPtr, int* loPtr);
 
-// The following class defines an instruction, represented in both
-// 	undecoded binary form
-//      decoded to identify
-//	    operation to do
-//	    registers to act on
-//	    any immediate operand value
-
-class Instruction {
-  public:
-    void Decode();	// decode the binary representation of the instruction
-
-    unsigned int value; // binary representation of the instruction
-
-    char opCode;     // Type of instruction.  This is NOT the same as the
-    		     // opcode field from the instruction: see defs in mips.h
-    char rs, rt, rd; // Three registers from instruction.
-    int extra;       // Immediate or target or shamt field or offset.
-                     // Immediates are sign-extended.
-};
-
 //----------------------------------------------------------------------
 // Machine::Run
 // 	Simulate the execution of a user-level program on Nachos.
@@ -52,29 +32,517 @@ class Instruction {
 //
 //	This routine is re-entrant, in that it can be called multiple
 //	times concurrently -- one for each thread executing user code.
+//
+//	In batched mode, we ask the interrupt simulation how many
+//	instructions can go by before OneTick has anything to do besides
+//	advancing the clock, and run that many without calling it.  Their
+//	ticks are saved up in "owedTicks" and put on the clock in one go
+//	(see SettleTicks) before OneTick or the kernel next looks at it,
+//	so simulated time comes out exactly the same.
 //----------------------------------------------------------------------
 
 void
 Machine::Run()
 {
-    Instruction *instr = new Instruction;  // storage for decoded instruction
-    
     if (debug->IsEnabled('m')) {
         cout << "Starting program in thread: " << kernel->currentThread->getName();
 		cout << ", at time: " << kernel->stats->totalTicks << "\n";
     }
     kernel->interrupt->setStatus(UserMode);
+#ifdef __GNUC__
+    // The threaded engine doesn't know about the debugger or about
+    // per-instruction tracing, so only use it when neither is wanted.
+    if (threadedCode != NULL && !singleStep && !debug->IsEnabled(dbgMach)
+		&& !debug->IsEnabled(dbgAddr))
+	RunThreaded();			// never returns
+#endif
     int counter = 0;
+    int quiet = 0;		// instructions to go before OneTick
+				// has something to do
+    int traps;
     for (;;) {
         //printf("%s %d\n", kernel->currentThread->getName(), counter++);
-        OneInstruction(instr);
+        traps = numTraps;
+        OneInstruction();
+	if (quiet > 0 && traps == numTraps) {	// only the clock changes
+	    quiet--;
+	    owedTicks++;
+	    continue;
+	}
+	SettleTicks();
 		kernel->interrupt->OneTick();
 		if (singleStep && (runUntilTime <= kernel->stats->totalTicks))
 	  		Debugger();
+	if (batchTicks && !singleStep)
+	    quiet = kernel->interrupt->QuietTicks();
     }
 }
 
 
+#ifdef __GNUC__
+//----------------------------------------------------------------------
+// Machine::RunThreaded
+// 	Simulate the execution of a user-level program, like Run, but 
+//	without going through the big switch in OneInstruction.
+//
+//	Each word of decodeCache gets a companion entry in threadedCode:
+//	the address of the code (a label below, using gcc's computed goto)
+//	that carries out that instruction.  Starting at the PC, we walk
+//	straight down the page jumping from handler to handler, and only
+//	go back to translating the PC when the straight-line run (the 
+//	"block") ends: after a taken branch or jump, at the end of the 
+//	page, on a system call or other exception, when the block's page
+//	gets written to, or when OneTick does more than advance the clock
+//	(i.e., an interrupt handler or another thread got to run).
+//
+//	Within a block the instruction fetch isn't re-translated; this is
+//	safe since nothing but the running instruction can change the
+//	page table or memory until OneTick gets to run something else.
+//	With a TLB, each fetch has to be looked up again anyway, so every
+//	instruction is a block by itself.
+//
+//	The less common instructions (LWL/LWR/SWL/SWR, syscall and the 
+//	illegal ones) are left to OneInstruction.
+//
+//	In batched mode, the instructions that Interrupt::QuietTicks says
+//	can't cause anything to happen don't call OneTick at all (see Run).
+//
+//	The register, memory and tick results are identical to Run's.
+//	Never returns.
+//----------------------------------------------------------------------
+
+void
+Machine::RunThreaded()
+{
+    static void *handlers[MaxOpcode + 1];  // label for each opCode
+    Instruction *instr;		// instruction being executed
+    void **code;		// its handler, in threadedCode
+    int physicalAddress;	// where it is in mainMemory
+    int page;			// the physical page of the current block
+    int ticks;			// totalTicks before calling OneTick
+    int quiet = 0;		// instructions to go before OneTick
+				// has something to do
+    int nextLoadReg, nextLoadValue, pcAfter;
+    int sum, diff, tmp, value;
+    unsigned int rs, rt, imm;
+    ExceptionType exception;
+
+    if (handlers[0] == NULL) {
+	for (int i = 0; i <= MaxOpcode; i++)
+	    handlers[i] = &&do_OneInstruction;
+	handlers[OP_ADD] = &&do_ADD;
+	handlers[OP_ADDI] = &&do_ADDI;
+	handlers[OP_ADDIU] = &&do_ADDIU;
+	handlers[OP_ADDU] = &&do_ADDU;
+	handlers[OP_AND] = &&do_AND;
+	handlers[OP_ANDI] = &&do_ANDI;
+	handlers[OP_BEQ] = &&do_BEQ;
+	handlers[OP_BGEZ] = &&do_BGEZ;
+	handlers[OP_BGEZAL] = &&do_BGEZAL;
+	handlers[OP_BGTZ] = &&do_BGTZ;
+	handlers[OP_BLEZ] = &&do_BLEZ;
+	handlers[OP_BLTZ] = &&do_BLTZ;
+	handlers[OP_BLTZAL] = &&do_BLTZAL;
+	handlers[OP_BNE] = &&do_BNE;
+	handlers[OP_DIV] = &&do_DIV;
+	handlers[OP_DIVU] = &&do_DIVU;
+	handlers[OP_J] = &&do_J;
+	handlers[OP_JAL] = &&do_JAL;
+	handlers[OP_JALR] = &&do_JALR;
+	handlers[OP_JR] = &&do_JR;
+	handlers[OP_LB] = &&do_LB;
+	handlers[OP_LBU] = &&do_LB;
+	handlers[OP_LH] = &&do_LH;
+	handlers[OP_LHU] = &&do_LH;
+	handlers[OP_LUI] = &&do_LUI;
+	handlers[OP_LW] = &&do_LW;
+	handlers[OP_MFHI] = &&do_MFHI;
+	handlers[OP_MFLO] = &&do_MFLO;
+	handlers[OP_MTHI] = &&do_MTHI;
+	handlers[OP_MTLO] = &&do_MTLO;
+	handlers[OP_MULT] = &&do_MULT;
+	handlers[OP_MULTU] = &&do_MULTU;
+	handlers[OP_NOR] = &&do_NOR;
+	handlers[OP_OR] = &&do_OR;
+	handlers[OP_ORI] = &&do_ORI;
+	handlers[OP_SB] = &&do_SB;
+	handlers[OP_SH] = &&do_SH;
+	handlers[OP_SLL] = &&do_SLL;
+	handlers[OP_SLLV] = &&do_SLLV;
+	handlers[OP_SLT] = &&do_SLT;
+	handlers[OP_SLTI] = &&do_SLTI;
+	handlers[OP_SLTIU] = &&do_SLTIU;
+	handlers[OP_SLTU] = &&do_SLTU;
+	handlers[OP_SRA] = &&do_SRA;
+	handlers[OP_SRAV] = &&do_SRAV;
+	handlers[OP_SRL] = &&do_SRL;
+	handlers[OP_SRLV] = &&do_SRLV;
+	handlers[OP_SUB] = &&do_SUB;
+	handlers[OP_SUBU] = &&do_SUBU;
+	handlers[OP_SW] = &&do_SW;
+	handlers[OP_XOR] = &&do_XOR;
+	handlers[OP_XORI] = &&do_XORI;
+    }
+
+  newBlock:
+    exception = Translate(registers[PCReg], &physicalAddress, 4, FALSE);
+    if (exception != NoException) {
+	RaiseException(exception, registers[PCReg]);
+	goto trapped;
+    }
+    page = physicalAddress / PageSize;
+    instr = &decodeCache[physicalAddress / 4];
+    code = &threadedCode[physicalAddress / 4];
+
+  dispatch:
+    if (*code == NULL) {		// first time through here
+	if (instr->opCode == 0) {
+	    instr->value = 
+		WordToHost(*(unsigned int *) &mainMemory[physicalAddress]);
+	    instr->Decode();
+	    decodedPage[page] = TRUE;
+	}
+	*code = handlers[(int) instr->opCode];
+    }
+    nextLoadReg = 0;
+    nextLoadValue = 0;
+    pcAfter = registers[NextPCReg] + 4;
+    goto **code;
+
+  do_ADD:
+    sum = registers[instr->rs] + registers[instr->rt];
+    if (!((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
+	((registers[instr->rs] ^ sum) & SIGN_BIT)) {
+	RaiseException(OverflowException, 0);
+	goto trapped;
+    }
+    registers[instr->rd] = sum;
+    goto done;
+
+  do_ADDI:
+    sum = registers[instr->rs] + instr->extra;
+    if (!((registers[instr->rs] ^ instr->extra) & SIGN_BIT) &&
+	((instr->extra ^ sum) & SIGN_BIT)) {
+	RaiseException(OverflowException, 0);
+	goto trapped;
+    }
+    registers[instr->rt] = sum;
+    goto done;
+
+  do_ADDIU:
+    registers[instr->rt] = registers[instr->rs] + instr->extra;
+    goto done;
+
+  do_ADDU:
+    registers[instr->rd] = registers[instr->rs] + registers[instr->rt];
+    goto done;
+
+  do_AND:
+    registers[instr->rd] = registers[instr->rs] & registers[instr->rt];
+    goto done;
+
+  do_ANDI:
+    registers[instr->rt] = registers[instr->rs] & (instr->extra & 0xffff);
+    goto done;
+
+  do_BEQ:
+    if (registers[instr->rs] == registers[instr->rt])
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    goto done;
+
+  do_BGEZAL:
+    registers[R31] = registers[NextPCReg] + 4;
+  do_BGEZ:
+    if (!(registers[instr->rs] & SIGN_BIT))
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    goto done;
+
+  do_BGTZ:
+    if (registers[instr->rs] > 0)
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    goto done;
+
+  do_BLEZ:
+    if (registers[instr->rs] <= 0)
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    goto done;
+
+  do_BLTZAL:
+    registers[R31] = registers[NextPCReg] + 4;
+  do_BLTZ:
+    if (registers[instr->rs] & SIGN_BIT)
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    goto done;
+
+  do_BNE:
+    if (registers[instr->rs] != registers[instr->rt])
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    goto done;
+
+  do_DIV:
+    if (registers[instr->rt] == 0) {
+	registers[LoReg] = 0;
+	registers[HiReg] = 0;
+    } else {
+	registers[LoReg] =  registers[instr->rs] / registers[instr->rt];
+	registers[HiReg] = registers[instr->rs] % registers[instr->rt];
+    }
+    goto done;
+
+  do_DIVU:
+    rs = (unsigned int) registers[instr->rs];
+    rt = (unsigned int) registers[instr->rt];
+    if (rt == 0) {
+	registers[LoReg] = 0;
+	registers[HiReg] = 0;
+    } else {
+	tmp = rs / rt;
+	registers[LoReg] = (int) tmp;
+	tmp = rs % rt;
+	registers[HiReg] = (int) tmp;
+    }
+    goto done;
+
+  do_JAL:
+    registers[R31] = registers[NextPCReg] + 4;
+  do_J:
+    pcAfter = (pcAfter & 0xf0000000) | IndexToAddr(instr->extra);
+    goto done;
+
+  do_JALR:
+    registers[instr->rd] = registers[NextPCReg] + 4;
+  do_JR:
+    pcAfter = registers[instr->rs];
+    goto done;
+
+  do_LB:				// also LBU
+    tmp = registers[instr->rs] + instr->extra;
+    if (!ReadMem(tmp, 1, &value))
+	goto trapped;
+    if ((value & 0x80) && (instr->opCode == OP_LB))
+	value |= 0xffffff00;
+    else
+	value &= 0xff;
+    nextLoadReg = instr->rt;
+    nextLoadValue = value;
+    goto done;
+
+  do_LH:				// also LHU
+    tmp = registers[instr->rs] + instr->extra;
+    if (tmp & 0x1) {
+	RaiseException(AddressErrorException, tmp);
+	goto trapped;
+    }
+    if (!ReadMem(tmp, 2, &value))
+	goto trapped;
+    if ((value & 0x8000) && (instr->opCode == OP_LH))
+	value |= 0xffff0000;
+    else
+	value &= 0xffff;
+    nextLoadReg = instr->rt;
+    nextLoadValue = value;
+    goto done;
+
+  do_LUI:
+    registers[instr->rt] = instr->extra << 16;
+    goto done;
+
+  do_LW:
+    tmp = registers[instr->rs] + instr->extra;
+    if (tmp & 0x3) {
+	RaiseException(AddressErrorException, tmp);
+	goto trapped;
+    }
+    if (!ReadMem(tmp, 4, &value))
+	goto trapped;
+    nextLoadReg = instr->rt;
+    nextLoadValue = value;
+    goto done;
+
+  do_MFHI:
+    registers[instr->rd] = registers[HiReg];
+    goto done;
+
+  do_MFLO:
+    registers[instr->rd] = registers[LoReg];
+    goto done;
+
+  do_MTHI:
+    registers[HiReg] = registers[instr->rs];
+    goto done;
+
+  do_MTLO:
+    registers[LoReg] = registers[instr->rs];
+    goto done;
+
+  do_MULT:
+    Mult(registers[instr->rs], registers[instr->rt], TRUE,
+	 &registers[HiReg], &registers[LoReg]);
+    goto done;
+
+  do_MULTU:
+    Mult(registers[instr->rs], registers[instr->rt], FALSE,
+	 &registers[HiReg], &registers[LoReg]);
+    goto done;
+
+  do_NOR:
+    registers[instr->rd] = ~(registers[instr->rs] | registers[instr->rt]);
+    goto done;
+
+  do_OR:
+    registers[instr->rd] = registers[instr->rs] | registers[instr->rt];
+    goto done;
+
+  do_ORI:
+    registers[instr->rt] = registers[instr->rs] | (instr->extra & 0xffff);
+    goto done;
+
+  do_SB:
+    if (!WriteMem((unsigned) 
+	    (registers[instr->rs] + instr->extra), 1, registers[instr->rt]))
+	goto trapped;
+    goto done;
+
+  do_SH:
+    if (!WriteMem((unsigned) 
+	    (registers[instr->rs] + instr->extra), 2, registers[instr->rt]))
+	goto trapped;
+    goto done;
+
+  do_SLL:
+    registers[instr->rd] = registers[instr->rt] << instr->extra;
+    goto done;
+
+  do_SLLV:
+    registers[instr->rd] = registers[instr->rt] <<
+	(registers[instr->rs] & 0x1f);
+    goto done;
+
+  do_SLT:
+    if (registers[instr->rs] < registers[instr->rt])
+	registers[instr->rd] = 1;
+    else
+	registers[instr->rd] = 0;
+    goto done;
+
+  do_SLTI:
+    if (registers[instr->rs] < instr->extra)
+	registers[instr->rt] = 1;
+    else
+	registers[instr->rt] = 0;
+    goto done;
+
+  do_SLTIU:
+    rs = registers[instr->rs];
+    imm = instr->extra;
+    if (rs < imm)
+	registers[instr->rt] = 1;
+    else
+	registers[instr->rt] = 0;
+    goto done;
+
+  do_SLTU:
+    rs = registers[instr->rs];
+    rt = registers[instr->rt];
+    if (rs < rt)
+	registers[instr->rd] = 1;
+    else
+	registers[instr->rd] = 0;
+    goto done;
+
+  do_SRA:
+    registers[instr->rd] = registers[instr->rt] >> instr->extra;
+    goto done;
+
+  do_SRAV:
+    registers[instr->rd] = registers[instr->rt] >>
+	(registers[instr->rs] & 0x1f);
+    goto done;
+
+  do_SRL:
+    tmp = registers[instr->rt];
+    tmp >>= instr->extra;
+    registers[instr->rd] = tmp;
+    goto done;
+
+  do_SRLV:
+    tmp = registers[instr->rt];
+    tmp >>= (registers[instr->rs] & 0x1f);
+    registers[instr->rd] = tmp;
+    goto done;
+
+  do_SUB:
+    diff = registers[instr->rs] - registers[instr->rt];
+    if (((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
+	((registers[instr->rs] ^ diff) & SIGN_BIT)) {
+	RaiseException(OverflowException, 0);
+	goto trapped;
+    }
+    registers[instr->rd] = diff;
+    goto done;
+
+  do_SUBU:
+    registers[instr->rd] = registers[instr->rs] - registers[instr->rt];
+    goto done;
+
+  do_SW:
+    if (!WriteMem((unsigned) 
+	    (registers[instr->rs] + instr->extra), 4, registers[instr->rt]))
+	goto trapped;
+    goto done;
+
+  do_XOR:
+    registers[instr->rd] = registers[instr->rs] ^ registers[instr->rt];
+    goto done;
+
+  do_XORI:
+    registers[instr->rt] = registers[instr->rs] ^ (instr->extra & 0xffff);
+    goto done;
+
+  do_OneInstruction:
+    OneInstruction();		// it fetches the instruction again, but
+				// these are rare
+    goto trapped;		// might have been a syscall
+
+  done:
+    // Do any delayed load operation, and advance the program counters,
+    // as at the end of OneInstruction.
+    DelayedLoad(nextLoadReg, nextLoadValue);
+    registers[PrevPCReg] = registers[PCReg];
+    registers[PCReg] = registers[NextPCReg];
+    registers[NextPCReg] = pcAfter;
+
+    if (quiet > 0) {			// only the clock changes
+	quiet--;
+	owedTicks++;
+    } else {
+	SettleTicks();
+	ticks = kernel->stats->totalTicks;
+	kernel->interrupt->OneTick();
+	if (batchTicks)
+	    quiet = kernel->interrupt->QuietTicks();
+	if (kernel->stats->totalTicks != ticks + UserTick)
+	    goto newBlock;		// something else got to run
+    }
+    if (registers[PCReg] == registers[PrevPCReg] + 4
+		&& (physicalAddress + 4) % PageSize != 0
+		&& decodedPage[page] && tlb == NULL) {
+	physicalAddress += 4;		// stay in this block
+	instr++;
+	code++;
+	goto dispatch;
+    }
+    goto newBlock;
+
+  trapped:
+    SettleTicks();
+    kernel->interrupt->OneTick();
+    if (batchTicks)
+	quiet = kernel->interrupt->QuietTicks();
+    goto newBlock;
+}
+#endif // __GNUC__
+
 //----------------------------------------------------------------------
 // TypeToReg
 // 	Retrieve the register # referred to in an instruction. 
@@ -121,22 +589,21 @@ TypeToReg(RegType reg, Instruction *instr)
 //----------------------------------------------------------------------
 
 void
-Machine::OneInstruction(Instruction *instr)
+Machine::OneInstruction()
 {
 #ifdef SIM_FIX
     int byte;       // described in Kane for LWL,LWR,...
 #endif
 
-    int raw;
+    Instruction *instr;
     int nextLoadReg = 0; 	
     int nextLoadValue = 0; 	// record delayed load operation, to apply
 				// in the future
 
     // Fetch instruction 
-    if (!ReadMem(registers[PCReg], 4, &raw))
+    instr = FetchInstruction();
+    if (instr == NULL)
 	return;			// exception occurred
-    instr->value = raw;
-    instr->Decode();
 
     if (debug->IsEnabled('m')) {
         struct OpString *str = &opStrings[instr->opCode];
@@ -703,6 +1170,69 @@ Machine::OneInstruction(Instruction *instr)
     registers[NextPCReg] = pcAfter;
 }
 
+//----------------------------------------------------------------------
+// Machine::FetchInstruction
+// 	Return the decoded form of the instruction at the current PC.
+//
+//	Decoding is pure bit-shuffling on the instruction word, so we 
+//	only do it the first time a word of mainMemory is executed, and
+//	keep the result in decodeCache until the page holding it is 
+//	written (see InvalidateDecodeCache).  The address translation is
+//	still done on every fetch, so page faults, use bits, etc. behave
+//	exactly as before.
+//
+//	Returns NULL if the fetch caused an exception.
+//----------------------------------------------------------------------
+
+Instruction *
+Machine::FetchInstruction()
+{
+    int pc = registers[PCReg];
+    int physicalAddress;
+    ExceptionType exception;
+    Instruction *instr;
+
+    DEBUG(dbgAddr, "Reading VA " << pc << ", size 4");
+
+    exception = Translate(pc, &physicalAddress, 4, FALSE);
+    if (exception != NoException) {
+	RaiseException(exception, pc);
+	return NULL;
+    }
+    instr = &decodeCache[physicalAddress / 4];
+    if (instr->opCode == 0) {		// first time through here
+	instr->value = 
+		WordToHost(*(unsigned int *) &mainMemory[physicalAddress]);
+	instr->Decode();
+	decodedPage[physicalAddress / PageSize] = TRUE;
+    }
+    return instr;
+}
+
+//----------------------------------------------------------------------
+// Machine::InvalidateDecodeCache
+// 	Throw away the decoded instructions of one physical page, because
+//	its contents are about to change (or just have).
+//
+//	"physPage" -- the physical page number
+//----------------------------------------------------------------------
+
+void
+Machine::InvalidateDecodeCache(int physPage)
+{
+    Instruction *instr;
+
+    if (!decodedPage[physPage])
+	return;
+    instr = &decodeCache[physPage * (PageSize / 4)];
+    for (int i = 0; i < PageSize / 4; i++)
+	instr[i].opCode = 0;
+    if (threadedCode != NULL)
+	for (int i = 0; i < PageSize / 4; i++)
+	    threadedCode[physPage * (PageSize / 4) + i] = NULL;
+    decodedPage[physPage] = FALSE;
+}
+
 //----------------------------------------------------------------------
 // Machine::DelayedLoad
 // 	Simulate effects of a delayed load.
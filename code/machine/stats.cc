@@ -10,6 +10,70 @@
 #include "copyright.h"
 #include "debug.h"
 #include "stats.h"
+#include <algorithm>
+#include <vector>
+
+//----------------------------------------------------------------------
+// ThreadStatistics::ThreadStatistics
+// 	Initialize the metrics of a new thread to zero.
+//
+//	"threadID", "threadName" -- identify the thread in the printout
+//----------------------------------------------------------------------
+
+ThreadStatistics::ThreadStatistics(int threadID, char *threadName)
+{
+    id = threadID;
+    name = threadName;
+    numTLBHits = numTLBMisses = 0;
+    createTick = 0;
+    firstRunTick = finishTick = -1;
+    for (int i = 0; i < 4; i++)
+	readyTicks[i] = 0;
+    numPromotions = 0;
+    numVoluntarySwitches = numInvoluntarySwitches = 0;
+    numBursts = burstError = 0;
+    readyQueue = readySince = predictedBurst = 0;
+    next = NULL;
+}
+
+//----------------------------------------------------------------------
+// ThreadStatistics::Dispatched
+// 	The thread has been picked to run.  Note when it first ran, and
+//	how long MLFQ expects this burst to be.
+//
+//	"now" -- the time
+//	"predicted" -- the thread's burst estimate, t
+//----------------------------------------------------------------------
+
+void
+ThreadStatistics::Dispatched(int now, int predicted)
+{
+    if (firstRunTick < 0)
+	firstRunTick = now;
+    predictedBurst = predicted;
+}
+
+//----------------------------------------------------------------------
+// ThreadStatistics::Switched
+// 	The thread has stopped running: count the switch, and how far
+//	the burst was from the estimate.
+//
+//	"burst" -- how many ticks it ran for
+//	"voluntary" -- did it block or finish, rather than being
+//		preempted?
+//----------------------------------------------------------------------
+
+void
+ThreadStatistics::Switched(int burst, bool voluntary)
+{
+    if (voluntary)
+	numVoluntarySwitches++;
+    else
+	numInvoluntarySwitches++;
+    numBursts++;
+    burstError += (burst > predictedBurst) ? burst - predictedBurst
+					    : predictedBurst - burst;
+}
 
 //----------------------------------------------------------------------
 // Statistics::Statistics
@@ -22,6 +86,47 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numPageWritebacks = 0;
+    numFrameAllocs = numFrameFrees = maxFramesInUse = 0;
+    numTLBHits = numTLBMisses = 0;
+    numTLBFlushes = numTLBFlushedEntries = 0;
+    firstThread = lastThread = NULL;
+}
+
+//----------------------------------------------------------------------
+// Statistics::~Statistics
+// 	De-allocate the records kept for each thread.
+//----------------------------------------------------------------------
+
+Statistics::~Statistics()
+{
+    while (firstThread != NULL) {
+	ThreadStatistics *record = firstThread;
+	firstThread = record->next;
+	delete record;
+    }
+}
+
+//----------------------------------------------------------------------
+// Statistics::NewThread
+// 	Return a new, zeroed, record for a thread that is being created.
+//	The record belongs to us, not to the thread.
+//
+//	"threadID", "threadName" -- identify the thread in the printout
+//----------------------------------------------------------------------
+
+ThreadStatistics *
+Statistics::NewThread(int threadID, char *threadName)
+{
+    ThreadStatistics *record = new ThreadStatistics(threadID, threadName);
+
+    record->createTick = totalTicks;
+    if (lastThread == NULL)
+	firstThread = record;
+    else
+	lastThread->next = record;
+    lastThread = record;
+    return record;
 }
 
 //----------------------------------------------------------------------
@@ -39,7 +144,94 @@ Statistics::Print()
 		cout << ", writes " << numDiskWrites << "\n";
 		cout << "Console I/O: reads " << numConsoleCharsRead;
     cout << ", writes " << numConsoleCharsWritten << "\n";
-    cout << "Paging: faults " << numPageFaults << "\n";
+    cout << "Paging: faults " << numPageFaults;
+    cout << ", writebacks " << numPageWritebacks << "\n";
+    if (numFrameAllocs > 0) {
+	cout << "Frames: allocated " << numFrameAllocs;
+	cout << ", freed " << numFrameFrees;
+	cout << ", at most " << maxFramesInUse << " in use\n";
+    }
+    if (numTLBHits + numTLBMisses > 0) {
+	cout << "TLB: hits " << numTLBHits << ", misses " << numTLBMisses;
+	cout << ", flushes " << numTLBFlushes;
+	cout << " (" << numTLBFlushedEntries << " entries)\n";
+	for (ThreadStatistics *t = firstThread; t != NULL; t = t->next) {
+	    if (t->numTLBHits + t->numTLBMisses == 0)
+		continue;
+	    cout << "  thread " << t->id << " (" << t->name << "): hits ";
+	    cout << t->numTLBHits << ", misses " << t->numTLBMisses << "\n";
+	}
+    }
     cout << "Network I/O: packets received " << numPacketsRecvd;
 		cout << ", sent " << numPacketsSent << "\n";
+    PrintScheduling();
+}
+
+//----------------------------------------------------------------------
+// PrintPercentiles
+// 	Print the 50th, 90th and 99th percentiles of some values, and the
+//	largest, by nearest rank.
+//----------------------------------------------------------------------
+
+static void
+PrintPercentiles(const char *what, std::vector<int> &values)
+{
+    static int percents[] = { 50, 90, 99 };
+    int n = values.size();
+
+    std::sort(values.begin(), values.end());
+    cout << "  " << what << " ";
+    for (int i = 0; i < 3; i++)
+	cout << values[divRoundUp(n * percents[i], 100) - 1] << " / ";
+    cout << values[n - 1] << "\n";
+}
+
+//----------------------------------------------------------------------
+// Statistics::PrintScheduling
+// 	Print, for each thread that has run, how long it took to first
+//	run (response) and to finish (turnaround), how long it was ready
+//	in each queue, how often it was aged up, how it gave up the CPU,
+//	and how far MLFQ's burst estimates were out on average.  Then
+//	the percentiles of those over all the threads.
+//
+//	Threads that haven't finished count up to now.
+//----------------------------------------------------------------------
+
+void
+Statistics::PrintScheduling()
+{
+    std::vector<int> response, turnaround, ready, error;
+
+    for (ThreadStatistics *t = firstThread; t != NULL; t = t->next) {
+	int end = (t->finishTick >= 0) ? t->finishTick : totalTicks;
+	int waited = t->readyTicks[0] + t->readyTicks[1] + t->readyTicks[2]
+			+ t->readyTicks[3];
+	int meanError = (t->numBursts > 0) ? t->burstError / t->numBursts : 0;
+
+	if (t->firstRunTick < 0)
+	    continue;			// never dispatched
+	if (response.empty())
+	    cout << "Scheduling:\n";
+	cout << "  thread " << t->id << " (" << t->name << "): response ";
+	cout << t->firstRunTick - t->createTick;
+	cout << ", turnaround " << end - t->createTick;
+	cout << ", ready " << waited << " (L1 " << t->readyTicks[1];
+	cout << ", L2 " << t->readyTicks[2] << ", L3 " << t->readyTicks[3];
+	cout << "), promotions " << t->numPromotions;
+	cout << ", switches " << t->numVoluntarySwitches << " voluntary ";
+	cout << t->numInvoluntarySwitches << " involuntary";
+	cout << ", burst error " << meanError << "\n";
+
+	response.push_back(t->firstRunTick - t->createTick);
+	turnaround.push_back(end - t->createTick);
+	ready.push_back(waited);
+	error.push_back(meanError);
+    }
+    if (response.empty())
+	return;
+    cout << "Scheduling percentiles (50th / 90th / 99th / max):\n";
+    PrintPercentiles("response", response);
+    PrintPercentiles("turnaround", turnaround);
+    PrintPercentiles("ready", ready);
+    PrintPercentiles("burst error", error);
 }
@@ -13,6 +13,51 @@
 
 #include "copyright.h"
 
+// The following class defines the statistics kept for each thread.
+// A thread's record outlives the thread itself, so that it can still
+// be printed when Nachos halts.
+
+class ThreadStatistics {
+  public:
+    ThreadStatistics(int threadID, char *threadName);
+				// initialize everything to zero
+
+    int id;			// the thread's ID and name, for printing
+    char *name;
+    int numTLBHits;		// number of translations found in the TLB
+    int numTLBMisses;		// number of TLB misses the kernel handled
+
+    int createTick;		// when the thread was created
+    int firstRunTick;		// when it first ran, or -1
+    int finishTick;		// when it finished, or -1
+    int readyTicks[4];		// time spent ready, in the ready queue
+				// of a CFS, stride or EDF scheduler (0),
+				// or in MLFQ's L1, L2 or L3 (1-3)
+    int numPromotions;		// times aged up into a higher queue
+    int numVoluntarySwitches;	// times it blocked or finished
+    int numInvoluntarySwitches;	// times it was preempted
+    int numBursts;		// CPU bursts it has finished
+    int burstError;		// total difference between the burst
+				// MLFQ predicted (t) and the real one
+
+    void EnterQueue(int queue, int now) { readyQueue = queue; readySince = now; }
+    void LeaveQueue(int now) { readyTicks[readyQueue] += now - readySince; }
+				// the thread went into, or came out of,
+				// a ready queue
+    void Dispatched(int now, int predicted);
+				// it was picked to run, and is expected
+				// to run for "predicted" ticks
+    void Switched(int burst, bool voluntary);
+				// it stopped running, after "burst" ticks
+
+    ThreadStatistics *next;	// next record, in order of creation
+
+  private:
+    int readyQueue;		// the ready queue it is in
+    int readySince;		// and when it went in
+    int predictedBurst;		// t when it was last picked
+};
+
 // The following class defines the statistics that are to be kept
 // about Nachos behavior -- how much time (ticks) elapsed, how
 // many user instructions executed, etc.
@@ -33,12 +78,32 @@ class Statistics {
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+    int numPageWritebacks;	// number of pages written to the swap area
+    int numFrameAllocs;		// number of free page frames handed out
+    int numFrameFrees;		// number of page frames given back
+    int maxFramesInUse;		// most page frames ever in use at once
+    int numTLBHits;		// number of translations found in the TLB
+    int numTLBMisses;		// number of translations not in the TLB
+    int numTLBFlushes;		// number of times the TLB was emptied
+				// on a context switch
+    int numTLBFlushedEntries;	// number of valid entries thrown away
+				// by those flushes
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
 
     Statistics(); 		// initialize everything to zero
+    ~Statistics();		// de-allocate the per-thread records
+
+    ThreadStatistics *NewThread(int threadID, char *threadName);
+				// make a record for a new thread
 
     void Print();		// print collected statistics
+    void PrintScheduling();	// print the per-thread scheduling
+				// metrics, and their percentiles
+
+  private:
+    ThreadStatistics *firstThread;	// per-thread records, oldest first
+    ThreadStatistics *lastThread;
 };
 
 // Constants used to reflect the relative time an operation would
@@ -55,6 +120,7 @@ const int RotationTime = 500; 	// time disk takes to rotate one sector
 const int SeekTime =	 500;  	// time disk takes to seek past one track
 const int ConsoleTime =	 100;	// time to read or write one character
 const int NetworkTime =	 100;  	// time to send or receive one packet
-const int TimerTicks = 	 100;  	// (average) time between timer interrupts
+const int TimerTicks = 	 100;  	// (average) time between timer interrupts,
+					// unless tuned (see schedparams.h)
 
 #endif // STATS_H
@@ -5,7 +5,9 @@
 //      This means it can be used for implementing time-slicing.
 //
 //      We emulate a hardware timer by scheduling an interrupt to occur
-//      every time stats->totalTicks has increased by TimerTicks.
+//      every time stats->totalTicks has increased by the timer's ticks.
+//	While the device is turned off, no interrupts are scheduled at
+//	all; see Timer::SetInterrupt for when they start again.
 //
 //      In order to introduce some randomness into time-slicing, if "doRandom"
 //      is set, then the interrupt is comes after a random number of ticks.
@@ -33,13 +35,17 @@
 //      "doRandom" -- if true, arrange for the interrupts to occur
 //		at random, instead of fixed, intervals.
 //      "toCall" is the interrupt handler to call when the timer expires.
+//      "ticks" -- the (average) interval between interrupts.
 //----------------------------------------------------------------------
 
-Timer::Timer(bool doRandom, CallBackObj *toCall)
+Timer::Timer(bool doRandom, CallBackObj *toCall, int ticks)
 {
     randomize = doRandom;
     callPeriodically = toCall;
+    this->ticks = ticks;
     disable = FALSE;
+    pending = NULL;
+    nextTick = kernel->stats->totalTicks;
     SetInterrupt();
 }
 
@@ -52,6 +58,9 @@ Timer::Timer(bool doRandom, CallBackObj *toCall)
 void 
 Timer::CallBack() 
 {
+    pending = NULL;		// it has occurred
+    nextTick = kernel->stats->totalTicks;	// (perhaps a little late)
+
     // invoke the Nachos interrupt handler for this device
     callPeriodically->CallBack();
     
@@ -64,18 +73,56 @@ Timer::CallBack()
 //      Cause a timer interrupt to occur in the future, unless
 //	future interrupts have been disabled.  The delay is either
 //	fixed or random.
+//
+//	A fixed delay counts from when the last interrupt occurred, or
+//	if the device was turned off since, from when it would have: it
+//	is the first of the interrupts that would have come every "ticks"
+//	ticks that is still to come.  (Interrupts that occur while the
+//	machine is idle are never late, so an idle gap changes nothing.)
+//	A random delay just counts from now.
 //----------------------------------------------------------------------
 
 void
 Timer::SetInterrupt() 
 {
-    if (!disable) {
-       int delay = TimerTicks;
-    
+    int now = kernel->stats->totalTicks;
+
+    if (!disable && pending == NULL) {
        if (randomize) {
-	     delay = 1 + (RandomNumber() % (TimerTicks * 2));
-        }
+	     nextTick = now + 1 + (RandomNumber() % (ticks * 2));
+       } else if (nextTick <= now) {
+	     nextTick += ((now - nextTick) / ticks + 1) * ticks;
+       }
        // schedule the next timer device interrupt
-       kernel->interrupt->Schedule(this, delay, TimerInt);
+       pending = kernel->interrupt->Schedule(this, nextTick - now, TimerInt);
+    }
+}
+
+//----------------------------------------------------------------------
+// Timer::Disable
+//      Turn the timer device off: take back its next interrupt, if it
+//	has one scheduled, and schedule no more.  May be called from the
+//	interrupt handler.
+//
+// Timer::Enable
+//      Turn the timer device back on, if it was off.
+//----------------------------------------------------------------------
+
+void
+Timer::Disable()
+{
+    disable = TRUE;
+    if (pending != NULL) {
+	kernel->interrupt->Cancel(pending);
+	pending = NULL;
+    }
+}
+
+void
+Timer::Enable()
+{
+    if (disable) {
+	disable = FALSE;
+	SetInterrupt();
     }
 }
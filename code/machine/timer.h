@@ -6,11 +6,18 @@
 //	having a thread go to sleep for a specific period of time. 
 //
 //	We emulate a hardware timer by scheduling an interrupt to occur
-//	every time stats->totalTicks has increased by TimerTicks.
+//	every time stats->totalTicks has increased by a given number of
+//	ticks (TimerTicks, unless the scheduler is tuned otherwise).
 //
 //	In order to introduce some randomness into time-slicing, if "doRandom"
 //	is set, then the interrupt comes after a random number of ticks.
 //
+//	The timer can be turned off while its interrupts would be of no
+//	use (say, while the machine is idle), and on again.  A timer that
+//	isn't random keeps its phase while it is off: its next interrupt
+//	comes a whole number of intervals after the last one, just where
+//	it would have come had the timer been on all along.
+//
 //  DO NOT CHANGE -- part of the machine emulation
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
@@ -24,23 +31,30 @@
 #include "utility.h"
 #include "callback.h"
 
+class PendingInterrupt;
+
 // The following class defines a hardware timer. 
 class Timer : public CallBackObj {
   public:
-    Timer(bool doRandom, CallBackObj *toCall);
+    Timer(bool doRandom, CallBackObj *toCall, int ticks);
 				// Initialize the timer, and callback to "toCall"
-				// every time slice.
+				// every time slice, of "ticks" ticks.
     virtual ~Timer() {}
     
-    void Disable() { disable = TRUE; }
-    				// Turn timer device off, so it doesn't
+    void Disable();		// Turn timer device off, so it doesn't
 				// generate any more interrupts.
+    void Enable();		// Turn it back on, if it was off.
+    bool IsEnabled() { return !disable; }
 
   private:
     bool randomize;		// set if we need to use a random timeout delay
-    CallBackObj *callPeriodically; // call this every TimerTicks time units 
-    bool disable;		// turn off the timer device after next
-    				// interrupt.
+    CallBackObj *callPeriodically; // call this every "ticks" time units 
+    int ticks;			// (average) time between interrupts
+    bool disable;		// the timer device has been turned off
+    int nextTick;		// when the next interrupt is (or, if the
+				// device is off, would have been) due
+    PendingInterrupt *pending;	// its next interrupt, if one is
+				// scheduled
     
     void CallBack();		// called internally when the hardware
 				// timer generates an interrupt
@@ -69,11 +69,65 @@ unsigned short
 ShortToMachine(unsigned short shortword) { return ShortToHost(shortword); }
 
 
+//----------------------------------------------------------------------
+// ReadHost, WriteHost
+//      Read or write "size" (1, 2, or 4) bytes of the simulated machine's
+//	memory, at a host address that has already been translated.
+//----------------------------------------------------------------------
+
+static int
+ReadHost(char *hostAddr, int size)
+{
+    int data;
+
+    switch (size) {
+      case 1:
+	data = *hostAddr;
+	return data;
+	
+      case 2:
+	data = *(unsigned short *) hostAddr;
+	return ShortToHost(data);
+	
+      case 4:
+	data = *(unsigned int *) hostAddr;
+	return WordToHost(data);
+
+      default: ASSERT(FALSE);
+    }
+    return 0;
+}
+
+static void
+WriteHost(char *hostAddr, int size, int value)
+{
+    switch (size) {
+      case 1:
+	*hostAddr = (unsigned char) (value & 0xff);
+	break;
+
+      case 2:
+	*(unsigned short *) hostAddr
+		= ShortToMachine((unsigned short) (value & 0xffff));
+	break;
+      
+      case 4:
+	*(unsigned int *) hostAddr = WordToMachine((unsigned int) value);
+	break;
+	
+      default: ASSERT(FALSE);
+    }
+}
+
 //----------------------------------------------------------------------
 // Machine::ReadMem
 //      Read "size" (1, 2, or 4) bytes of virtual memory at "addr" into 
 //	the location pointed to by "value".
 //
+//	If the page has been read since the host TLB was last flushed, 
+//	its translation is still good, and its use bit is already set,
+//	so we can go straight to mainMemory.
+//
 //   	Returns FALSE if the translation step from virtual to physical memory
 //   	failed.
 //
@@ -85,10 +139,16 @@ ShortToMachine(unsigned short shortword) { return ShortToHost(shortword); }
 bool
 Machine::ReadMem(int addr, int size, int *value)
 {
-    int data;
     ExceptionType exception;
     int physicalAddress;
+    unsigned int vpn = (unsigned) addr / PageSize;
+    HostTranslation *cached = &readHostTLB[vpn % HostTLBSize];
     
+    if (cached->virtualPage == (int) vpn && (addr & (size - 1)) == 0) {
+	*value = ReadHost(cached->hostPage + (unsigned) addr % PageSize, size);
+	return TRUE;
+    }
+
     DEBUG(dbgAddr, "Reading VA " << addr << ", size " << size);
     
     exception = Translate(addr, &physicalAddress, size, FALSE);
@@ -96,24 +156,12 @@ Machine::ReadMem(int addr, int size, int *value)
 	RaiseException(exception, addr);
 	return FALSE;
     }
-    switch (size) {
-      case 1:
-	data = mainMemory[physicalAddress];
-	*value = data;
-	break;
-	
-      case 2:
-	data = *(unsigned short *) &mainMemory[physicalAddress];
-	*value = ShortToHost(data);
-	break;
-	
-      case 4:
-	data = *(unsigned int *) &mainMemory[physicalAddress];
-	*value = WordToHost(data);
-	break;
-
-      default: ASSERT(FALSE);
+    if (hostTLBEnabled) {
+	cached->virtualPage = vpn;
+	cached->physicalPage = physicalAddress / PageSize;
+	cached->hostPage = &mainMemory[cached->physicalPage * PageSize];
     }
+    *value = ReadHost(&mainMemory[physicalAddress], size);
     
     DEBUG(dbgAddr, "\tvalue read = " << *value);
     return (TRUE);
@@ -124,6 +172,9 @@ Machine::ReadMem(int addr, int size, int *value)
 //      Write "size" (1, 2, or 4) bytes of the contents of "value" into
 //	virtual memory at location "addr".
 //
+//	As in ReadMem, pages written since the host TLB was last flushed
+//	(so that their dirty bit is already set) skip the translation.
+//
 //   	Returns FALSE if the translation step from virtual to physical memory
 //   	failed.
 //
@@ -137,6 +188,15 @@ Machine::WriteMem(int addr, int size, int value)
 {
     ExceptionType exception;
     int physicalAddress;
+    unsigned int vpn = (unsigned) addr / PageSize;
+    HostTranslation *cached = &writeHostTLB[vpn % HostTLBSize];
+
+    if (cached->virtualPage == (int) vpn && (addr & (size - 1)) == 0) {
+	if (decodedPage[cached->physicalPage])	// writing over code?
+	    InvalidateDecodeCache(cached->physicalPage);
+	WriteHost(cached->hostPage + (unsigned) addr % PageSize, size, value);
+	return TRUE;
+    }
      
     DEBUG(dbgAddr, "Writing VA " << addr << ", size " << size << ", value " << value);
 
@@ -145,27 +205,36 @@ Machine::WriteMem(int addr, int size, int value)
 	RaiseException(exception, addr);
 	return FALSE;
     }
-    switch (size) {
-      case 1:
-	mainMemory[physicalAddress] = (unsigned char) (value & 0xff);
-	break;
-
-      case 2:
-	*(unsigned short *) &mainMemory[physicalAddress]
-		= ShortToMachine((unsigned short) (value & 0xffff));
-	break;
-      
-      case 4:
-	*(unsigned int *) &mainMemory[physicalAddress]
-		= WordToMachine((unsigned int) value);
-	break;
-	
-      default: ASSERT(FALSE);
+    if (decodedPage[physicalAddress / PageSize])    // writing over code?
+	InvalidateDecodeCache(physicalAddress / PageSize);
+    if (hostTLBEnabled) {
+	cached->virtualPage = vpn;
+	cached->physicalPage = physicalAddress / PageSize;
+	cached->hostPage = &mainMemory[cached->physicalPage * PageSize];
     }
+    WriteHost(&mainMemory[physicalAddress], size, value);
     
     return TRUE;
 }
 
+//----------------------------------------------------------------------
+// Machine::FlushHostTLB
+// 	Empty the caches of translations used by ReadMem and WriteMem.
+//	Needed on a context switch, and whenever the kernel changes 
+//	the translations, or the use and dirty bits, of the running 
+//	program; otherwise the next access to the page wouldn't see the
+//	change.
+//----------------------------------------------------------------------
+
+void
+Machine::FlushHostTLB()
+{
+    for (int i = 0; i < HostTLBSize; i++) {
+	readHostTLB[i].virtualPage = -1;
+	writeHostTLB[i].virtualPage = -1;
+    }
+}
+
 //----------------------------------------------------------------------
 // Machine::Translate
 // 	Translate a virtual address into a physical address, using 
@@ -214,18 +283,24 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 	    return PageFaultException;
 	}
 	entry = &pageTable[vpn];
-    } else {
-        for (entry = NULL, i = 0; i < TLBSize; i++)
-    	    if (tlb[i].valid && (tlb[i].virtualPage == ((int)vpn))) {
-		entry = &tlb[i];			// FOUND!
+    } else {			// => TLB => search the set vpn maps to
+	TranslationEntry *set = &tlb[(vpn % (tlbSize / tlbWays)) * tlbWays];
+
+        for (entry = NULL, i = 0; i < tlbWays; i++)
+    	    if (set[i].valid && (set[i].virtualPage == ((int)vpn))) {
+		entry = &set[i];			// FOUND!
 		break;
 	    }
 	if (entry == NULL) {				// not found
     	    DEBUG(dbgAddr, "Invalid TLB entry for this virtual page!");
+	    kernel->stats->numTLBMisses++;
+	    kernel->currentThread->statistics->numTLBMisses++;
     	    return PageFaultException;		// really, this is a TLB fault,
 						// the page may be in memory,
 						// but not in the TLB
 	}
+	kernel->stats->numTLBHits++;
+	kernel->currentThread->statistics->numTLBHits++;
     }
 
     if (entry->readOnly && writing) {	// trying to write to a read-only page
@@ -236,7 +311,7 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 
     // if the pageFrame is too big, there is something really wrong! 
     // An invalid translation was loaded into the page table or TLB. 
-    if (pageFrame >= NumPhysPages) { 
+    if (pageFrame >= (unsigned) numPhysPages) { 
 	DEBUG(dbgAddr, "Illegal pageframe " << pageFrame);
 	return BusErrorException;
     }
@@ -244,7 +319,7 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     if (writing)
 	entry->dirty = TRUE;
     *physAddr = pageFrame * PageSize + offset;
-    ASSERT((*physAddr >= 0) && ((*physAddr + size) <= MemorySize));
+    ASSERT((*physAddr >= 0) && ((*physAddr + size) <= memorySize));
     DEBUG(dbgAddr, "phys addr = " << *physAddr);
     return NoException;
 }
@@ -42,4 +42,18 @@ class TranslationEntry {
 			// page is modified.
 };
 
+// The following class defines an entry in the simulator's own cache
+// of translations (the "host TLB"), which lets ReadMem and WriteMem
+// skip Translate for pages they have already been through.  Unlike 
+// the entries above, it is not visible to the Nachos kernel.
+
+class HostTranslation {
+  public:
+    int virtualPage;	// The page number in virtual memory, or -1 if
+			// the entry is empty.
+    int physicalPage;	// The page number in real memory.
+    char *hostPage;	// Where that page is in the host's memory,
+			// i.e., &mainMemory[physicalPage * PageSize].
+};
+
 #endif
@@ -43,13 +43,18 @@ Mail::Mail(PacketHeader pktH, MailHeader mailH, char *msgData)
 //      Initialize a single mail box within the post office, so that it
 //	can receive incoming messages.
 //
-//	Just initialize a list of messages, representing the mailbox.
+//	Just initialize a list of messages, representing the mailbox,
+//	named after the box, so each box has a line of its own in the
+//	lock profile.
+//
+//	"box" is the mail box's number
 //----------------------------------------------------------------------
 
 
-MailBox::MailBox()
+MailBox::MailBox(int box)
 { 
-    messages = new SynchList<Mail *>(); 
+    sprintf(name, "mailbox %d", box);
+    messages = new SynchList<Mail *>(name); 
 }
 
 //----------------------------------------------------------------------
@@ -155,7 +160,9 @@ PostOfficeInput::PostOfficeInput(int nBoxes)
     messageAvailable = new Semaphore("message available", 0);
 
     numBoxes = nBoxes;
-    boxes = new MailBox[nBoxes];
+    boxes = new MailBox *[nBoxes];
+    for (int i = 0; i < nBoxes; i++)
+	boxes[i] = new MailBox(i);
 
     network = new NetworkInput(this);
 
@@ -177,6 +184,8 @@ PostOfficeInput::PostOfficeInput(int nBoxes)
 PostOfficeInput::~PostOfficeInput()
 {
     delete network;
+    for (int i = 0; i < numBoxes; i++)
+	delete boxes[i];
     delete [] boxes;
 }
 
@@ -212,7 +221,7 @@ PostOfficeInput::PostalDelivery(void* data)
 	ASSERT(mailHdr.length <= MaxMailSize);
 
 	// put into mailbox
-        _this->boxes[mailHdr.to].Put(pktHdr, mailHdr, buffer + sizeof(MailHeader));
+        _this->boxes[mailHdr.to]->Put(pktHdr, mailHdr, buffer + sizeof(MailHeader));
     }
 }
 
@@ -237,7 +246,7 @@ PostOfficeInput::Receive(int box, PacketHeader *pktHdr,
 {
     ASSERT((box >= 0) && (box < numBoxes));
 
-    boxes[box].Get(pktHdr, mailHdr, data);
+    boxes[box]->Get(pktHdr, mailHdr, data);
     ASSERT(mailHdr->length <= MaxMailSize);
 }
 
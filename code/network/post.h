@@ -80,7 +80,7 @@ class Mail {
 
 class MailBox {
   public: 
-    MailBox();			// Allocate and initialize mail box
+    MailBox(int box);		// Allocate and initialize mail box "box"
     ~MailBox();			// De-allocate mail box
 
     void Put(PacketHeader pktHdr, MailHeader mailHdr, char *data);
@@ -91,6 +91,7 @@ class MailBox {
 				// to get!)
   private:
     SynchList<Mail *> *messages; // A mailbox is just a list of arrived messages
+    char name[20];		// "mailbox N", the list's name
 };
 
 // The following two classes defines a "Post Office", or a collection of 
@@ -122,7 +123,7 @@ class PostOfficeInput : public CallBackObj {
 
   private:
     NetworkInput *network;	// Physical network connection
-    MailBox *boxes;		// Table of mail boxes to hold incoming mail
+    MailBox **boxes;		// Table of mail boxes to hold incoming mail
     int numBoxes;		// Number of mail boxes
     Semaphore *messageAvailable;// V'ed when message has arrived from network
 };
@@ -0,0 +1,24 @@
+/* cpubound.c
+ *	Synthetic CPU-bound job, for loading the scheduler (see
+ *	threads/workload.h): a long stretch of arithmetic, with no
+ *	system calls until it exits, so it only gives up the CPU when
+ *	it is preempted.
+ *
+ *	The work is a linear congruential generator, so the compiler
+ *	can't fold it away, and the result is the exit value.
+ */
+
+#include "syscall.h"
+
+#define Rounds	20000	/* about 10 instructions a round */
+
+int
+main()
+{
+    int i, x = 1;
+
+    for (i = 0; i < Rounds; i++)
+	x = x * 1103515245 + 12345;
+
+    Exit(x & 0x7fff);
+}
@@ -0,0 +1,28 @@
+/* iobound.c
+ *	Synthetic I/O-bound job, for loading the scheduler (see
+ *	threads/workload.h): short CPU bursts, each followed by console
+ *	output, which blocks the thread for ConsoleTime ticks a
+ *	character.  So it gives up the CPU of its own accord, often.
+ *
+ *	Run with "-co /dev/null" to throw the output away.
+ */
+
+#include "syscall.h"
+
+#define Bursts		50	/* bursts of CPU, each ... */
+#define BurstRounds	100	/* about 10 instructions a round ... */
+				/* then a number printed */
+
+int
+main()
+{
+    int i, j, x = 1;
+
+    for (i = 0; i < Bursts; i++) {
+	for (j = 0; j < BurstRounds; j++)
+	    x = x * 1103515245 + 12345;
+	PrintInt(x & 0x7fff);
+    }
+
+    Exit(0);
+}
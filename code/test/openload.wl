@@ -0,0 +1,11 @@
+# openload.wl
+#	An open-arrival workload (see threads/workload.h): two CPU-bound
+#	jobs in L3 from the start, a stream of I/O-bound jobs in L1,
+#	and a slower stream of CPU-bound jobs in L2.
+#
+#	nachos -co /dev/null -wl openload.wl
+#
+# program	priority	arrival	count	interval
+cpubound	20		0	2	0
+iobound		120		500	1000	2000
+cpubound	70		1000	100	20000
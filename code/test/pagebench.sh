@@ -0,0 +1,33 @@
+#!/bin/sh
+#
+# pagebench.sh
+#	Compare the page replacement policies (nachos -pr) on a few
+#	workloads, and print the page faults, writebacks and total ticks
+#	of each run.
+#
+#	Usage: ./pagebench.sh [nachos binary]
+#
+#	Run from the test directory, after "make matmult sort".  The
+#	nachos binary defaults to ../build.linux/nachos.  Each workload
+#	is a list of programs run together; "mixed" runs more than fit
+#	in physical memory at once.
+
+NACHOS=${1:-../build.linux/nachos}
+POLICIES="fifo clock eclock aging ws"
+
+run() {
+    name=$1
+    shift
+    for policy in $POLICIES; do
+	$NACHOS -pr $policy "$@" 2>&1 | awk -v name="$name" -v policy="$policy" '
+	    /^Ticks:/  { ticks = $3; sub(",", "", ticks) }
+	    /^Paging:/ { faults = $3; sub(",", "", faults); writebacks = $5 }
+	    END { printf "%-8s %-8s %10s %10s %12s\n", name, policy,
+			faults, writebacks, ticks }'
+    done
+}
+
+printf "%-8s %-8s %10s %10s %12s\n" workload policy faults writebacks ticks
+run matmult -e matmult
+run sort -e sort
+run mixed -e matmult -e sort -e matmult -e sort
@@ -0,0 +1,98 @@
+#!/bin/sh
+#
+# schedsweep.sh
+#	Run a workload under every combination of a grid of MLFQ
+#	settings (nachos -sc), and print, for each, the throughput
+#	(programs finished per 100000 ticks), the mean and 99th
+#	percentile turnaround of the programs, and the number of
+#	context switches.
+#
+#	Usage: ./schedsweep.sh [nachos binary [workload flags...]]
+#
+#	Run from the test directory, after "make matmult sort".  The
+#	nachos binary defaults to ../build.linux/nachos, and the
+#	workload to a mix of matmult and sort at priorities in each
+#	band.  The grid is set by the environment, a list of values
+#	for each parameter (see threads/schedparams.h):
+#
+#	  AGING   agingTicks   (default "750 1500 3000")
+#	  STEP    agingStep    (default "5 10 20")
+#	  SLICE   timerTicks   (default "50 100 200")
+#	  WEIGHT  burstWeight  (default "25 50 75")
+#
+#	The runs are independent, so JOBS of them (default, the number
+#	of host processors) go at once.  The scheduler trace is kept
+#	quiet, so only the statistics printed at halt are parsed.
+
+NACHOS=${1:-../build.linux/nachos}
+[ $# -gt 0 ] && shift
+[ $# -eq 0 ] && set -- -ep matmult 120 -ep sort 110 -ep matmult 80 \
+			-ep sort 60 -ep matmult 30 -ep sort 10
+AGING=${AGING:-"750 1500 3000"}
+STEP=${STEP:-"5 10 20"}
+SLICE=${SLICE:-"50 100 200"}
+WEIGHT=${WEIGHT:-"25 50 75"}
+JOBS=${JOBS:-$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 2)}
+
+OUT=$(mktemp -d "${TMPDIR:-/tmp}/schedsweep.XXXXXX") || exit 1
+trap 'rm -rf "$OUT"' 0
+
+# Run one setting, and print its line of results.  Programs are the
+# threads other than main and the postal worker; switches are counted
+# over every thread.
+
+run() {
+    setting="$1 $2 $3 $4"
+    flags="-sc agingTicks=$1 -sc agingStep=$2 -sc timerTicks=$3 -sc burstWeight=$4"
+    shift 4
+    $NACHOS -st quiet $flags "$@" 2>&1 |
+    awk -v setting="$setting" '
+	/^Ticks:/ { ticks = $3; sub(",", "", ticks) }
+	/^  thread .*turnaround/ {
+	    for (i = 1; i <= NF; i++) {
+		if ($i == "turnaround") { t = $(i + 1); sub(",", "", t) }
+		if ($i == "switches") switches += $(i + 1) + $(i + 3)
+	    }
+	    if ($0 !~ /\((main|postal worker)\)/) {
+		turnaround[n++] = t
+		sum += t
+	    }
+	}
+	END {
+	    split(setting, s, " ")
+	    if (n == 0 || ticks == 0) {
+		printf "%6s %5s %6s %6s %s\n", s[1], s[2], s[3], s[4], "failed"
+		exit
+	    }
+	    for (i = 1; i < n; i++)		# sort, for the percentile
+		for (j = i; j > 0 && turnaround[j - 1] > turnaround[j]; j--) {
+		    x = turnaround[j]; turnaround[j] = turnaround[j - 1]
+		    turnaround[j - 1] = x
+		}
+	    p99 = turnaround[int((n * 99 + 99) / 100) - 1]
+	    printf "%6s %5s %6s %6s %10.2f %10d %10d %9d\n", s[1], s[2],
+		s[3], s[4], n * 100000 / ticks, sum / n, p99, switches
+	}'
+}
+
+n=0
+for aging in $AGING; do
+    for step in $STEP; do
+	for slice in $SLICE; do
+	    for weight in $WEIGHT; do
+		n=$((n + 1))
+		run $aging $step $slice $weight "$@" > "$OUT/$n" &
+		[ $((n % JOBS)) -eq 0 ] && wait
+	    done
+	done
+    done
+done
+wait
+
+printf "%6s %5s %6s %6s %10s %10s %10s %9s\n" aging step slice weight \
+    throughput turnaround p99 switches
+i=1
+while [ $i -le $n ]; do
+    cat "$OUT/$i"
+    i=$((i + 1))
+done
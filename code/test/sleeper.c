@@ -0,0 +1,26 @@
+/* sleeper.c
+ *	Synthetic job that mostly sleeps, for loading the scheduler (see
+ *	threads/workload.h): short CPU bursts, each followed by a Sleep,
+ *	so it is off every queue most of the time.  Run many at once to
+ *	load the alarm clock's timer wheel.
+ */
+
+#include "syscall.h"
+
+#define Bursts		20	/* bursts of CPU, each ... */
+#define BurstRounds	100	/* about 10 instructions a round ... */
+#define SleepTicks	1000	/* then this long asleep */
+
+int
+main()
+{
+    int i, j, x = 1;
+
+    for (i = 0; i < Bursts; i++) {
+	for (j = 0; j < BurstRounds; j++)
+	    x = x * 1103515245 + 12345;
+	Sleep(SleepTicks);
+    }
+
+    Exit(x & 0x7f);
+}
@@ -1,8 +1,7 @@
 // alarm.cc
 //	Routines to use a hardware timer device to provide a
-//	software alarm clock.  For now, we just provide time-slicing.
-//
-//	Not completely implemented.
+//	software alarm clock: time-slicing, and waking threads that
+//	have asked to sleep for a while.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -11,6 +10,7 @@
 #include "copyright.h"
 #include "alarm.h"
 #include "main.h"
+#include <limits.h>
 
 //----------------------------------------------------------------------
 // Alarm::Alarm
@@ -18,18 +18,19 @@
 //
 //      "doRandom" -- if true, arrange for the hardware interrupts to 
 //		occur at random, instead of fixed, intervals.
+//      "sliceTicks" -- the (average) interval between them.
 //----------------------------------------------------------------------
 
-Alarm::Alarm(bool doRandom)
+Alarm::Alarm(bool doRandom, int sliceTicks)
 {
-    timer = new Timer(doRandom, this);
-    stat = true;
+    timer = new Timer(doRandom, this, sliceTicks);
+    sleepers = new TimerWheel(sliceTicks, kernel->stats->totalTicks);
 }
 
 //----------------------------------------------------------------------
 // Alarm::CallBack
 //	Software interrupt handler for the timer device. The timer device is
-//	set up to interrupt the CPU periodically (once every TimerTicks).
+//	set up to interrupt the CPU periodically (once every time slice).
 //	This routine is called each time there is a timer interrupt,
 //	with interrupts disabled.
 //
@@ -40,8 +41,17 @@ Alarm::Alarm(bool doRandom)
 //	if the interrupted thread called Yield at the point it is 
 //	was interrupted.
 //
-//	For now, just provide time-slicing.  Only need to time slice 
-//      if we're currently running something (in other words, not idle).
+//	First wake any sleeping threads whose time has come.  Then time
+//	slice: only need to if we're currently running something (in
+//	other words, not idle), and the scheduling policy says the
+//	running thread's slice is up.
+//
+//	If nothing is sleeping, and we're idle or the running thread
+//	isn't time-sliced (an MLFQ thread from L1 or L2, say), the
+//	interrupts that come until a thread is next dispatched or becomes
+//	ready will all be ignored, so the timer is turned off until then
+//	(see Alarm::Rearm).  An idle machine then goes straight to the
+//	next interrupt that matters.
 //----------------------------------------------------------------------
 
 void 
@@ -50,7 +60,82 @@ Alarm::CallBack()
     Interrupt *interrupt = kernel->interrupt;
     MachineStatus status = interrupt->getStatus();
     
-    if (status != IdleMode && stat) {
+    WakeSleepers();
+    if (status == IdleMode || !kernel->scheduler->WantsTimer()) {
+	if (sleepers->IsEmpty())
+	    timer->Disable();
+	return;
+    }
+    if (kernel->scheduler->SliceOver()) {
         interrupt->YieldOnReturn();
     }
 }
+
+//----------------------------------------------------------------------
+// Alarm::WaitUntil
+//	Put the current thread to sleep until the time is past now + x
+//	ticks.  It goes on the timer wheel, and is made ready again, by
+//	Scheduler::ReadyToRun, at the first timer interrupt after that;
+//	the timer is kept on for as long as anything is sleeping.
+//
+//	"x" -- how long to sleep, in ticks; if it isn't positive, don't
+//		sleep at all, and if it would take us past the last tick
+//		the clock can count, sleep until then
+//----------------------------------------------------------------------
+
+void
+Alarm::WaitUntil(int x)
+{
+    IntStatus oldLevel;
+    TimerEntry entry;			// on our stack while we sleep
+
+    if (x <= 0)
+	return;
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    DEBUG(dbgThread, "Sleeping for " << x << " ticks: "
+	  << kernel->currentThread->getName());
+
+    WakeSleepers();			// catch the wheel up to now
+    x = min(x, INT_MAX - kernel->stats->totalTicks - 1);
+    entry.thread = kernel->currentThread;
+    sleepers->Insert(&entry, kernel->stats->totalTicks + x + 1);
+    timer->Enable();			// if it was off
+    kernel->currentThread->Sleep(FALSE);
+
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Alarm::WakeSleepers
+//	Advance the timer wheel to now, and make ready every thread
+//	whose time is up, in the order they were due.  Interrupts are
+//	disabled.
+//----------------------------------------------------------------------
+
+void
+Alarm::WakeSleepers()
+{
+    TimerEntry *entry, *next;
+
+    for (entry = sleepers->Advance(kernel->stats->totalTicks);
+	 entry != NULL; entry = next) {
+	next = entry->next;		// the entry goes with its thread
+	kernel->scheduler->ReadyToRun(entry->thread);
+    }
+}
+
+//----------------------------------------------------------------------
+// Alarm::Rearm
+//	Called by the scheduler whenever a thread is dispatched or
+//	becomes ready, with interrupts disabled: if the timer was turned
+//	off, and the running thread's slice could now run out, turn it
+//	back on.  It keeps its phase (see Timer::SetInterrupt), so the
+//	next interrupt comes just when it would have anyway.
+//----------------------------------------------------------------------
+
+void
+Alarm::Rearm()
+{
+    if (!timer->IsEnabled() && kernel->scheduler->WantsTimer())
+	timer->Enable();
+}
@@ -8,7 +8,9 @@
 //	From this, we provide the ability for a thread to be
 //	woken up after a delay; we also provide time-slicing.
 //
-//	NOTE: this abstraction is not completely implemented.
+//	Sleeping threads wait on a timer wheel (see timerwheel.h), and
+//	are woken at the first timer interrupt at or after their time;
+//	so a sleep is rounded up to a whole number of timer periods.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -21,23 +23,27 @@
 #include "utility.h"
 #include "callback.h"
 #include "timer.h"
+#include "timerwheel.h"
 
 // The following class defines a software alarm clock. 
 class Alarm : public CallBackObj {
   public:
-    Alarm(bool doRandomYield);	// Initialize the timer, and callback 
+    Alarm(bool doRandomYield, int sliceTicks);
+				// Initialize the timer, and callback 
 				// to "toCall" every time slice.
-    ~Alarm() { delete timer; }
-    
-    void setStat(bool inStat) { stat = inStat; }
+    ~Alarm() { delete timer; delete sleepers; }
     
     void WaitUntil(int x);	// suspend execution until time > now + x
-                                // this method is not yet implemented
+
+    void Rearm();		// a thread has been dispatched or has
+				// become ready: turn the timer back on,
+				// if a time slice could now run out
 
   private:
     Timer *timer;		// the hardware timer device
-    
-    bool stat; // enable alarm when stat is true
+    TimerWheel *sleepers;	// the threads in WaitUntil
+
+    void WakeSleepers();	// make ready the threads whose time is up
 
     void CallBack();		// called when the hardware
 				// timer generates an interrupt
@@ -13,17 +13,26 @@
 #include "utility.h"
 #include "thread.h"
 #include "scheduler.h"
+#include "schedparams.h"
+#include "schedtrace.h"
+#include "workload.h"
+#include "proctable.h"
+#include "stackpool.h"
+#include "lockprofile.h"
 #include "interrupt.h"
 #include "stats.h"
 #include "alarm.h"
 #include "filesys.h"
 #include "machine.h"
+#include "tlbmanager.h"
+#include "replacement.h"
 
 class PostOfficeInput;
 class PostOfficeOutput;
 class SynchConsoleInput;
 class SynchConsoleOutput;
 class SynchDisk;
+class MemoryManager;
 
 
 
@@ -37,12 +46,16 @@ class Kernel {
 				// from constructor because 
 				// refers to "kernel" as a global
 	void ExecAll();
-	int Exec(char* name);
+	int Exec(char* name, int priority, Thread *parent);
     void ThreadSelfTest();	// self test of threads and synchronization
+    void SchedulerBenchmark();	// time dispatching with many ready threads
+    void InterruptBenchmark();	// time interrupts with many pending
+    void InversionBenchmark();	// measure priority inversion
 	
     void ConsoleTest();         // interactive console self test
     void NetworkTest();         // interactive 2-machine network test
-	Thread* getThread(int threadID){return t[threadID];}    
+    Thread *getThread(int pid) { return processTable->Lookup(pid); }
+				// the process with a PID, or NULL
 	
 	int CreateFile(char* filename); // fileSystem call
     int Open(char *name);
@@ -56,6 +69,13 @@ class Kernel {
 
     Thread *currentThread;	// the thread holding the CPU
     Scheduler *scheduler;	// the ready list
+    SchedParams *schedParams;	// how the scheduler is tuned
+    Workload *workload;		// the user programs to run, and when
+    ProcessTable *processTable;	// the processes alive, by PID
+    StackPool *stackPool;	// thread stacks, kept for reuse
+    SchedTrace *schedTrace;	// the scheduler's event trace
+    LockProfile *lockProfile;	// contention on locks and conditions,
+				// or NULL if not profiling
     Interrupt *interrupt;	// interrupt status
     Statistics *stats;		// performance metrics
     Alarm *alarm;		// the software alarm clock    
@@ -66,18 +86,34 @@ class Kernel {
     FileSystem *fileSystem;     
     PostOfficeInput *postOfficeIn;
     PostOfficeOutput *postOfficeOut;
+    TLBManager *tlbManager;	// TLB miss handling; NULL if the
+				// machine has no TLB
+    MemoryManager *memoryManager; // physical frames and swap area
 
     int hostName;               // machine identifier
+    bool priorityInheritance;	// do lock holders inherit the priority
+				// of the threads waiting for them?
 
   private:
 
-	Thread* t[10];
-	char*   execfile[10];
-    int priority[10];
-	int execfileNum;
-	int threadNum;
     bool randomSlice;		// enable pseudo-random time slicing
     bool debugUserProg;         // single step user program
+    bool threadedCode;		// run user programs with the threaded-code
+				// engine rather than the reference one
+    bool batchTicks;		// advance the clock in bulk while running
+				// user programs
+    int tlbEntries;		// size of the TLB, if the machine has one
+    int tlbWays;		// and its associativity
+    TLBPolicy tlbPolicy;	// how TLB misses choose what to replace
+    PageReplacement pageReplacement; // how page faults choose a victim
+    SchedulingPolicyType schedulingPolicy; // which thread the scheduler
+				// runs next
+    ReadyQueueType readyQueueType; // how MLFQ keeps ready threads
+    bool lockProfiling;		// profile contention on locks?
+    TraceMode traceMode;	// what to do with scheduler events
+    char *traceFile;		// where to write them, or NULL
+    int physPages;		// pages of physical memory
+    char *memoryFile;		// host file to keep it in, or NULL
     double reliability;         // likelihood messages are dropped
     char *consoleIn;            // file to read console input from
     char *consoleOut;           // file to send console output to
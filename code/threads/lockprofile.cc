@@ -0,0 +1,198 @@
+// lockprofile.cc
+//	Routines to keep and report statistics on contention for locks
+//	and condition variables.  See lockprofile.h.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "lockprofile.h"
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+//----------------------------------------------------------------------
+// LockStats::LockStats, LockStats::~LockStats
+// 	Initialize the statistics for a name: nothing has happened yet.
+//	We keep a copy of the name, since the report is printed after
+//	the locks that own it may be gone (the mailboxes, say); or
+//	de-allocate the statistics, and the copy.
+//----------------------------------------------------------------------
+
+LockStats::LockStats(char *name, bool isCondition)
+{
+    this->name = new char[strlen(name) + 1];
+    strcpy(this->name, name);
+    this->isCondition = isCondition;
+    count = contended = 0;
+    totalWait = 0;
+    maxWait = 0;
+    for (int i = 0; i < NumHoldBuckets; i++)
+	holds[i] = 0;
+    signals = lostSignals = 0;
+}
+
+LockStats::~LockStats()
+{
+    delete [] name;
+}
+
+//----------------------------------------------------------------------
+// LockStats::Acquired, LockStats::Released
+// 	A lock was acquired -- "contended" if it was held at the time,
+//	in which case we waited "waited" ticks for it -- or released,
+//	"held" ticks after it was acquired.
+//----------------------------------------------------------------------
+
+void
+LockStats::Acquired(bool contended, int waited)
+{
+    count++;
+    if (contended) {
+	this->contended++;
+	totalWait += waited;
+	maxWait = max(maxWait, waited);
+    }
+}
+
+void
+LockStats::Released(int held)
+{
+    int bucket = 0;
+
+    for (int limit = 10; bucket < NumHoldBuckets - 1 && held >= limit;
+	 limit *= 10)
+	bucket++;
+    holds[bucket]++;
+}
+
+//----------------------------------------------------------------------
+// LockStats::Waited, LockStats::Signalled
+// 	A condition's Wait was signalled, "waited" ticks after it began;
+//	or Signal was called, and "woke" a thread or found none waiting.
+//----------------------------------------------------------------------
+
+void
+LockStats::Waited(int waited)
+{
+    count++;
+    totalWait += waited;
+    maxWait = max(maxWait, waited);
+}
+
+void
+LockStats::Signalled(bool woke)
+{
+    if (woke)
+	signals++;
+    else
+	lostSignals++;
+}
+
+//----------------------------------------------------------------------
+// LockStats::Print
+// 	Print the statistics for a name, on one line.
+//----------------------------------------------------------------------
+
+void
+LockStats::Print()
+{
+    cout << "  " << name;
+    if (isCondition) {
+	cout << " (condition): waits " << count << ", waited " << totalWait;
+	cout << " (max " << maxWait << "), signals " << signals;
+	cout << " (" << lostSignals << " with nobody waiting)\n";
+	return;
+    }
+    cout << ": acquired " << count << " (" << contended << " contended)";
+    cout << ", waited " << totalWait << " (max " << maxWait << "), held";
+    for (int i = 0, limit = 10; i < NumHoldBuckets; i++, limit *= 10) {
+	if (i < NumHoldBuckets - 1)
+	    cout << " <" << limit;
+	else
+	    cout << " more";
+	cout << ":" << holds[i];
+    }
+    cout << "\n";
+}
+
+//----------------------------------------------------------------------
+// LockProfile::LockProfile, LockProfile::~LockProfile
+// 	Initialize an empty profile, or de-allocate one.  The locks and
+//	conditions that point to its statistics must not be used after.
+//----------------------------------------------------------------------
+
+LockProfile::LockProfile()
+{
+    entries = new List<LockStats *>;
+}
+
+LockProfile::~LockProfile()
+{
+    while (!entries->IsEmpty())
+	delete entries->RemoveFront();
+    delete entries;
+}
+
+//----------------------------------------------------------------------
+// LockProfile::Find
+// 	Return the statistics for the locks, or conditions, called
+//	"name", starting them if this is the first.  Only called when a
+//	lock or condition is created, so a search will do.
+//----------------------------------------------------------------------
+
+LockStats *
+LockProfile::Find(char *name, bool isCondition)
+{
+    ListIterator<LockStats *> iter(entries);
+    LockStats *stats;
+
+    for (; !iter.IsDone(); iter.Next()) {
+	stats = iter.Item();
+	if (stats->isCondition == isCondition && strcmp(stats->name, name) == 0)
+	    return stats;
+    }
+    stats = new LockStats(name, isCondition);
+    entries->Append(stats);
+    return stats;
+}
+
+//----------------------------------------------------------------------
+// WaitOrder
+// 	Order the report: the longest total wait first, then by name.
+//----------------------------------------------------------------------
+
+static bool
+WaitOrder(LockStats *s1, LockStats *s2)
+{
+    if (s1->totalWait != s2->totalWait)
+	return s1->totalWait > s2->totalWait;
+    return strcmp(s1->name, s2->name) < 0;
+}
+
+//----------------------------------------------------------------------
+// LockProfile::Print
+// 	Print the statistics for each name that was used, the names
+//	waited on longest first.
+//----------------------------------------------------------------------
+
+void
+LockProfile::Print()
+{
+    ListIterator<LockStats *> iter(entries);
+    std::vector<LockStats *> used;
+
+    for (; !iter.IsDone(); iter.Next()) {
+	LockStats *stats = iter.Item();
+
+	if (stats->count > 0 || stats->signals + stats->lostSignals > 0)
+	    used.push_back(stats);
+    }
+    std::sort(used.begin(), used.end(), WaitOrder);
+
+    cout << "Lock contention (ticks, by total wait):\n";
+    for (unsigned int i = 0; i < used.size(); i++)
+	used[i]->Print();
+}
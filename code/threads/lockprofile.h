@@ -0,0 +1,77 @@
+// lockprofile.h
+//	Data structures for profiling contention on locks and condition
+//	variables.
+//
+//	With -lp, each Lock and Condition is given the statistics kept
+//	for its name when it is created; locks (or conditions) with the
+//	same name share them.  (A SynchList's lock and condition take its
+//	name, so each PostOffice mailbox, "mailbox N", has its own.)  For a
+//	lock we count the acquisitions, how many had to wait, how long
+//	they waited, and how long the lock was held, in a histogram by
+//	powers of ten; for a condition, the waits, how long they waited
+//	to be signalled, and the signals.  The report is printed when
+//	the machine halts, the names waited on longest first.
+//
+//	Without -lp, kernel->lockProfile is NULL, and locks and
+//	conditions keep no statistics at all.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef LOCKPROFILE_H
+#define LOCKPROFILE_H
+
+#include "copyright.h"
+#include "list.h"
+
+// How many buckets the hold-time histogram has: holds of under 10
+// ticks, under 100, and so on, with the last for any longer.
+
+const int NumHoldBuckets = 5;
+
+// The statistics kept for the locks, or the conditions, of one name.
+
+class LockStats {
+  public:
+    LockStats(char *name, bool isCondition);
+    ~LockStats();
+
+    void Acquired(bool contended, int waited);
+				// a lock was acquired, after waiting
+				// "waited" ticks if it was held
+    void Released(int held);	// and released, "held" ticks later
+    void Waited(int waited);	// a condition's Wait was signalled,
+				// "waited" ticks after it began
+    void Signalled(bool woke);	// Signal was called, waking a thread
+				// or not
+    void Print();		// print them, on one line
+
+    char *name;			// the locks' or conditions' name (a copy)
+    bool isCondition;		// which of the two they are
+    int count;			// acquisitions, or waits
+    int contended;		// acquisitions that had to wait
+    long long totalWait;	// ticks waited, in all
+    int maxWait;		// and at most, at once
+    int holds[NumHoldBuckets];	// how many holds took how long
+    int signals;		// Signals that woke a thread
+    int lostSignals;		// and that found no thread waiting
+};
+
+// The statistics for every name.
+
+class LockProfile {
+  public:
+    LockProfile();
+    ~LockProfile();
+
+    LockStats *Find(char *name, bool isCondition);
+				// the statistics for a name, new if it
+				// has none yet
+    void Print();		// print the report, longest wait first
+
+  private:
+    List<LockStats *> *entries;	// for each name, in no order
+};
+
+#endif // LOCKPROFILE_H
@@ -3,22 +3,54 @@
 //	operating system kernel.  
 //
 // Usage: nachos -d <debugflags> -rs <random seed #>
-//              -s -x <nachos file> -ci <consoleIn> -co <consoleOut>
+//              -s -tc -bt -x <nachos file> -ci <consoleIn> -co <consoleOut>
+//              -tlb <entries> <ways> -tlbp <random|fifo|clock>
+//              -pr <fifo|clock|eclock|aging|ws> -mem <pages> -mf <memory file>
+//              -sp <mlfq|cfs|stride|edf> -rq <heap|array> -npi -lp
+//              -sc <name>=<value> -scf <settings file>
+//              -st <text|quiet|stream> -stf <trace file>
+//              -sd <trace file> <text|csv|gantt>
 //              -f -cp <unix file> <nachos file>
 //              -p <nachos file> -r <nachos file> -l -D
 //              -n <network reliability> -m <machine id>
-//              -z -K -C -N
+//              -z -K -B -C -N
 //
 //    -d causes certain debugging messages to be printed (see debug.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
 //    -z prints the copyright message
 //    -s causes user programs to be executed in single-step mode
+//    -tc runs user programs with the threaded-code engine
+//    -bt advances the clock in bulk while user programs run
+//    -tlb sets the size and associativity of the TLB (if USE_TLB)
+//    -tlbp chooses the entry a TLB miss replaces (if USE_TLB)
+//    -pr chooses the page a page fault evicts (see userprog/replacement.h)
+//    -mem sets the number of pages of physical memory (default 128; at
+//	most 2^23, or on a 32-bit host what fits in its address space --
+//	about 4M pages, or 3.3M with -tc; see Machine::MaxPhysPages)
+//    -mf keeps physical memory in a host file (created or truncated)
+//    -sp chooses the scheduling policy (see threads/schedpolicy.h)
+//    -rq chooses how the MLFQ policy keeps its ready queues (see
+//	threads/readyqueue.h)
+//    -npi turns off priority inheritance through locks (see
+//	threads/synch.h)
+//    -lp profiles contention on locks and condition variables, and
+//	prints a report when the machine halts (see threads/lockprofile.h)
+//    -sc sets a scheduler parameter, such as the aging interval or
+//	the time slice (see threads/schedparams.h); may be repeated
+//    -scf reads scheduler parameters from a file, one to a line
+//    -st chooses whether the scheduler's trace is printed, kept in
+//	memory, or written to the trace file (see threads/schedtrace.h)
+//    -stf names the trace file
+//    -sd decodes a trace file, and exits
 //    -x runs a user program
 //    -ci specify file for console input (stdin is the default)
 //    -co specify file for console output (stdout is the default)
 //    -n sets the network reliability
 //    -m sets this machine's host id (needed for the network)
 //    -K run a simple self test of kernel threads and synchronization
+//    -B time the scheduler's dispatch with many ready threads, and
+//	 the interrupt simulation with many interrupts pending; and
+//	 measure priority inversion with and without inheritance
 //    -C run an interactive console test
 //    -N run a two-machine network test (see Kernel::NetworkTest)
 //
@@ -169,8 +201,11 @@ main(int argc, char **argv)
     char *debugArg = "";
     char *userProgName = NULL;        // default is not to execute a user prog
     bool threadTestFlag = false;
+    bool schedulerBenchmarkFlag = false;
     bool consoleTestFlag = false;
     bool networkTestFlag = false;
+    char *decodeTraceFile = NULL;     // scheduler trace to decode
+    char *decodeFormat = NULL;        // and how
 #ifndef FILESYS_STUB
     char *copyUnixFileName = NULL;    // UNIX file to be copied into Nachos
     char *copyNachosFileName = NULL;  // name of copied file in Nachos
@@ -200,12 +235,21 @@ main(int argc, char **argv)
 	else if (strcmp(argv[i], "-K") == 0) {
 	    threadTestFlag = TRUE;
 	}
+	else if (strcmp(argv[i], "-B") == 0) {
+	    schedulerBenchmarkFlag = TRUE;
+	}
 	else if (strcmp(argv[i], "-C") == 0) {
 	    consoleTestFlag = TRUE;
 	}
 	else if (strcmp(argv[i], "-N") == 0) {
 	    networkTestFlag = TRUE;
 	}
+	else if (strcmp(argv[i], "-sd") == 0) {
+	    ASSERT(i + 2 < argc);
+	    decodeTraceFile = argv[i + 1];
+	    decodeFormat = argv[i + 2];
+	    i += 2;
+	}
 #ifndef FILESYS_STUB
 	else if (strcmp(argv[i], "-cp") == 0) {
 	    ASSERT(i + 2 < argc);
@@ -233,7 +277,8 @@ main(int argc, char **argv)
 	else if (strcmp(argv[i], "-u") == 0) {
             cout << "Partial usage: nachos [-z -d debugFlags]\n";
             cout << "Partial usage: nachos [-x programName]\n";
-	    cout << "Partial usage: nachos [-K] [-C] [-N]\n";
+	    cout << "Partial usage: nachos [-K] [-B] [-C] [-N]\n";
+	    cout << "Partial usage: nachos [-sd traceFile text|csv|gantt]\n";
 #ifndef FILESYS_STUB
             cout << "Partial usage: nachos [-cp UnixFile NachosFile]\n";
             cout << "Partial usage: nachos [-p fileName] [-r fileName]\n";
@@ -244,6 +289,11 @@ main(int argc, char **argv)
     }
     debug = new Debug(debugArg);
     
+    if (decodeTraceFile != NULL) {	// only decoding, offline: no
+	DecodeSchedTrace(decodeTraceFile, decodeFormat); // need for a
+	return 0;			// kernel
+    }
+
     DEBUG(dbgThread, "Entering main");
 
     kernel = new Kernel(argc, argv);
@@ -257,6 +307,11 @@ main(int argc, char **argv)
     if (threadTestFlag) {
       kernel->ThreadSelfTest();  // test threads and synchronization
     }
+    if (schedulerBenchmarkFlag) {
+      kernel->SchedulerBenchmark();  // time the ready queues
+      kernel->InterruptBenchmark();  // and the pending interrupts
+      kernel->InversionBenchmark();  // and priority inheritance
+    }
     if (consoleTestFlag) {
       kernel->ConsoleTest();   // interactive test of the synchronized console
     }
@@ -0,0 +1,277 @@
+// proctable.cc
+//	Routines to keep track of the user processes: hand out PIDs,
+//	find a process by PID, and keep the parent and child links.
+//	See proctable.h.
+//
+// 	These routines assume that interrupts are already disabled, or
+//	that they are called before any other thread runs.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "proctable.h"
+#include "thread.h"
+
+//----------------------------------------------------------------------
+// ProcessPid, HashPid
+// 	How the hash table finds a process: by its PID, which hashes to
+//	itself (PIDs are handed out in order, so they spread evenly).
+//----------------------------------------------------------------------
+
+static int
+ProcessPid(Process *process)
+{
+    return process->pid;
+}
+
+static unsigned
+HashPid(int pid)
+{
+    return (unsigned) pid;
+}
+
+static int
+PidCompare(int pid1, int pid2)
+{
+    if (pid1 != pid2)
+	return (pid1 < pid2) ? -1 : 1;
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::ProcessTable
+// 	Initialize an empty process table.
+//
+//	"recycleStart" -- how many PIDs to hand out before reusing any
+//----------------------------------------------------------------------
+
+ProcessTable::ProcessTable(int recycleStart)
+{
+    table = new HashTable<int, Process *>(ProcessPid, HashPid);
+    freePids = new Heap<int>(PidCompare);
+    nextPid = 0;
+    this->recycleStart = recycleStart;
+    numProcesses = 0;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::~ProcessTable
+// 	De-allocate the table, and the entries of the processes still in
+//	it.  The threads are the caller's.
+//----------------------------------------------------------------------
+
+ProcessTable::~ProcessTable()
+{
+    Process **remaining = new Process *[numProcesses];
+    HashIterator<int, Process *> iter(table);
+    int i, n = 0;
+
+    for (; !iter.IsDone(); iter.Next())
+	remaining[n++] = iter.Item();
+    for (i = 0; i < n; i++) {
+	(void) table->Remove(remaining[i]->pid);
+	delete remaining[i];
+    }
+    delete [] remaining;
+    delete table;
+    delete freePids;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::NewPid
+// 	Return the PID for a new process: the next one never used, or
+//	once recycleStart PIDs have been, the smallest free one, if there
+//	is one.
+//----------------------------------------------------------------------
+
+int
+ProcessTable::NewPid()
+{
+    if (nextPid >= recycleStart && !freePids->IsEmpty())
+	return freePids->RemoveMin();
+    return nextPid++;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Add
+// 	Put a thread into the table, as a child of "parent" (if that is
+//	a process).
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Add(Thread *thread, Thread *parent)
+{
+    Process *process = new Process;
+
+    process->pid = thread->getID();
+    process->thread = thread;
+    process->parent = (parent == NULL) ? NULL : Find(parent);
+    process->firstChild = NULL;
+    process->prevSibling = NULL;
+    process->nextSibling = NULL;
+    if (process->parent != NULL) {
+	process->nextSibling = process->parent->firstChild;
+	if (process->nextSibling != NULL)
+	    process->nextSibling->prevSibling = process;
+	process->parent->firstChild = process;
+    }
+    table->Insert(process);
+    numProcesses++;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Exit
+// 	A thread is finishing.  If it is a process, take it out of the
+//	table and out of its parent's children, orphan its own children,
+//	and let its PID be reused.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Exit(Thread *thread)
+{
+    Process *process = Find(thread);
+    Process *child, *next;
+
+    if (process == NULL)
+	return;				// not a process
+    if (process->prevSibling != NULL)
+	process->prevSibling->nextSibling = process->nextSibling;
+    else if (process->parent != NULL)
+	process->parent->firstChild = process->nextSibling;
+    if (process->nextSibling != NULL)
+	process->nextSibling->prevSibling = process->prevSibling;
+    for (child = process->firstChild; child != NULL; child = next) {
+	next = child->nextSibling;
+	child->parent = NULL;
+	child->prevSibling = child->nextSibling = NULL;
+    }
+
+    (void) table->Remove(process->pid);
+    freePids->Insert(process->pid);
+    numProcesses--;
+    delete process;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Find
+// 	Return a thread's entry, or NULL if it isn't a process.  A
+//	thread that isn't a process may have the same ID as one.
+//----------------------------------------------------------------------
+
+Process *
+ProcessTable::Find(Thread *thread)
+{
+    Process *process;
+
+    if (table->Find(thread->getID(), &process) && process->thread == thread)
+	return process;
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Lookup, ProcessTable::Parent
+// 	Return the process with a PID, or the parent of a process; or
+//	NULL if there isn't one.
+//----------------------------------------------------------------------
+
+Thread *
+ProcessTable::Lookup(int pid)
+{
+    Process *process;
+
+    if (table->Find(pid, &process))
+	return process->thread;
+    return NULL;
+}
+
+Thread *
+ProcessTable::Parent(Thread *thread)
+{
+    Process *process = Find(thread);
+
+    if (process == NULL || process->parent == NULL)
+	return NULL;
+    return process->parent->thread;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Print
+// 	Print each process: its PID, name, status, priority and parent.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Print()
+{
+    static const char *statusNames[] = { "just created", "running",
+					 "ready", "blocked", "zombie" };
+    HashIterator<int, Process *> iter(table);
+
+    cout << numProcesses << " processes:\n";
+    for (; !iter.IsDone(); iter.Next()) {
+	Process *process = iter.Item();
+	Thread *thread = process->thread;
+
+	cout << "  " << process->pid << " (" << thread->getName() << "): "
+	     << statusNames[thread->getStatus()] << ", priority "
+	     << thread->checkPriority() << ", parent ";
+	if (process->parent == NULL)
+	    cout << "none\n";
+	else
+	    cout << process->parent->pid << "\n";
+    }
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::SelfTest
+// 	Test whether this module is working, on an empty table that
+//	starts to reuse PIDs after 4: add a family of processes, check
+//	the links and lookups, then have them exit, in an order that
+//	takes children out of the front, middle and back of the list,
+//	and check which PIDs come back.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::SelfTest()
+{
+    Thread *threads[6];
+    int i;
+
+    ASSERT(recycleStart == 4 && NumProcesses() == 0);
+    for (i = 0; i < 4; i++) {
+	threads[i] = new Thread((char *) "process test", NewPid());
+	ASSERT(threads[i]->getID() == i);
+	Add(threads[i], (i == 0) ? NULL : threads[0]);
+    }
+    ASSERT(NumProcesses() == 4);
+    for (i = 0; i < 4; i++)
+	ASSERT(Lookup(i) == threads[i]);
+    ASSERT(Lookup(4) == NULL);
+    ASSERT(Parent(threads[0]) == NULL && Parent(threads[2]) == threads[0]);
+
+    Exit(threads[2]);			// the middle child
+    ASSERT(Lookup(2) == NULL && NumProcesses() == 3);
+    threads[4] = new Thread((char *) "process test", NewPid());
+    ASSERT(threads[4]->getID() == 2);	// reused
+    Add(threads[4], threads[3]);	// a grandchild
+    ASSERT(Parent(threads[4]) == threads[3]);
+    threads[5] = new Thread((char *) "process test", NewPid());
+    ASSERT(threads[5]->getID() == 4);	// none free, so count on
+    Add(threads[5], threads[0]);
+
+    Exit(threads[5]);			// the newest child
+    Exit(threads[1]);			// the oldest
+    Exit(threads[0]);			// the parent: 3 is orphaned
+    ASSERT(Parent(threads[3]) == NULL && Parent(threads[4]) == threads[3]);
+    Exit(threads[3]);
+    ASSERT(Parent(threads[4]) == NULL);
+    Exit(threads[4]);
+    ASSERT(NumProcesses() == 0 && table->IsEmpty());
+    i = NewPid();			// smallest free first
+    ASSERT(i == 0);
+    i = NewPid();
+    ASSERT(i == 1);
+    for (i = 0; i < 6; i++)
+	delete threads[i];
+}
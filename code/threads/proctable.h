@@ -0,0 +1,83 @@
+// proctable.h
+//	Data structures for the process table: the user processes that
+//	are alive, found by process ID (PID), with their parents and
+//	children.
+//
+//	A process is a thread, and its PID is the thread's ID.  PIDs
+//	are handed out in order, from 0 (main), until recycleStart have
+//	been used; after that, the PIDs of processes that have exited
+//	are reused, smallest first -- or, if there are none, the table
+//	carries on counting up, so it never runs out.  Looking up a PID
+//	takes constant time, however many processes there are, and
+//	adding a process or taking one out, O(log n) at worst (for the
+//	free PIDs).
+//
+//	When a process exits, its children become orphans (they have
+//	no parent).
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PROCTABLE_H
+#define PROCTABLE_H
+
+#include "copyright.h"
+#include "hash.h"
+#include "heap.h"
+
+class Thread;
+
+// An entry in the process table.  The children of a process are a
+// doubly linked list through their sibling links, so a child can be
+// taken out without a search.
+
+class Process {
+  public:
+    int pid;			// the thread's ID
+    Thread *thread;		// the thread itself
+    Process *parent;		// the process that started it, or NULL
+    Process *firstChild;	// its children, newest first
+    Process *prevSibling;	// the parent's next newer child
+    Process *nextSibling;	// and next older one
+};
+
+// PIDs start to be reused after this many, as with Linux's default
+// pid_max.
+
+const int PidRecycleStart = 32768;
+
+class ProcessTable {
+  public:
+    ProcessTable(int recycleStart);	// "recycleStart" -- when PIDs
+					// start to be reused
+    ~ProcessTable();
+
+    int NewPid();		// choose the PID for a new process
+    void Add(Thread *thread, Thread *parent);
+				// put a thread in the table; its ID must
+				// have come from NewPid.  "parent" may
+				// be NULL
+    void Exit(Thread *thread);	// take a thread out of the table, if it
+				// is there, and free its PID
+
+    Thread *Lookup(int pid);	// the process with a PID, or NULL
+    Thread *Parent(Thread *thread);
+				// the process that started it, or NULL
+    int NumProcesses() { return numProcesses; }
+
+    void Print();		// print each process, for debugging
+    void SelfTest();		// test whether this module is working
+
+  private:
+    Process *Find(Thread *thread);
+				// the thread's entry, or NULL
+
+    HashTable<int, Process *> *table;	// the processes, by PID
+    Heap<int> *freePids;	// PIDs free to reuse, smallest first
+    int nextPid;		// the next PID never used
+    int recycleStart;		// reuse PIDs once nextPid gets here
+    int numProcesses;		// processes in the table
+};
+
+#endif // PROCTABLE_H
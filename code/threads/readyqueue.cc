@@ -0,0 +1,277 @@
+// readyqueue.cc
+//	Routines to keep the ready threads in the order the scheduler
+//	picks them in.  See readyqueue.h for the order.
+//
+// 	These routines assume that interrupts are already disabled.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "readyqueue.h"
+#include "thread.h"
+#include "main.h"
+
+//----------------------------------------------------------------------
+// ReadyLevel
+// 	Return which band a thread belongs in, by its priority: 1 for
+//	L1 (the highest), 2 for L2, 3 for L3.  Where the bands start is
+//	a scheduler parameter (see schedparams.h).
+//----------------------------------------------------------------------
+
+int
+ReadyLevel(Thread *thread)
+{
+    if (thread->checkPriority() < kernel->schedParams->l2Floor)
+        return 3;
+    else if (thread->checkPriority() < kernel->schedParams->l1Floor)
+        return 2;
+    return 1;
+}
+
+//----------------------------------------------------------------------
+// L1Compare, L2Compare, L3Compare, SetReadyIndex
+// 	Order the bands of the ready queue (ties go FIFO), and keep
+//	track of where each thread is in its heap.
+//----------------------------------------------------------------------
+
+static int
+L1Compare(Thread *th1, Thread *th2)
+{
+    if (th1->checkT() != th2->checkT())
+        return (th1->checkT() < th2->checkT()) ? -1 : 1;
+    if (th1->checkReadySeq() != th2->checkReadySeq())
+        return (th1->checkReadySeq() < th2->checkReadySeq()) ? -1 : 1;
+    return 0;
+}
+
+static int
+L2Compare(Thread *th1, Thread *th2)
+{
+    if (th1->checkPriority() != th2->checkPriority())
+        return (th1->checkPriority() > th2->checkPriority()) ? -1 : 1;
+    if (th1->checkReadySeq() != th2->checkReadySeq())
+        return (th1->checkReadySeq() < th2->checkReadySeq()) ? -1 : 1;
+    return 0;
+}
+
+static int
+L3Compare(Thread *th1, Thread *th2)
+{
+    if (th1->checkReadySeq() != th2->checkReadySeq())
+        return (th1->checkReadySeq() < th2->checkReadySeq()) ? -1 : 1;
+    return 0;
+}
+
+static void
+SetReadyIndex(Thread *thread, int index)
+{
+    thread->setReadyIndex(index);
+}
+
+//----------------------------------------------------------------------
+// ReadyQueue::RemoveFront
+// 	Take the next thread to run out of the queue, and return it,
+//	or NULL if there are no ready threads.
+//----------------------------------------------------------------------
+
+Thread *
+ReadyQueue::RemoveFront()
+{
+    Thread *thread = Front();
+
+    if (thread != NULL)
+        Remove(thread);
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// HeapQueue::HeapQueue, HeapQueue::~HeapQueue
+// 	Initialize and de-allocate the heaps.
+//----------------------------------------------------------------------
+
+HeapQueue::HeapQueue()
+{
+    bands[0] = new Heap<Thread *>(L1Compare, SetReadyIndex);
+    bands[1] = new Heap<Thread *>(L2Compare, SetReadyIndex);
+    bands[2] = new Heap<Thread *>(L3Compare, SetReadyIndex);
+}
+
+HeapQueue::~HeapQueue()
+{
+    for (int i = 0; i < 3; i++)
+        delete bands[i];
+}
+
+//----------------------------------------------------------------------
+// HeapQueue::Insert, HeapQueue::Remove, HeapQueue::Changed
+// 	Put a thread into the heap of its band, take it out, or move it
+//	to its new place.
+//----------------------------------------------------------------------
+
+void
+HeapQueue::Insert(Thread *thread)
+{
+    bands[ReadyLevel(thread) - 1]->Insert(thread);
+}
+
+void
+HeapQueue::Remove(Thread *thread)
+{
+    bands[ReadyLevel(thread) - 1]->Remove(thread->checkReadyIndex());
+}
+
+void
+HeapQueue::Changed(Thread *thread, int /* oldPriority */)
+{
+    bands[ReadyLevel(thread) - 1]->Changed(thread->checkReadyIndex());
+}
+
+//----------------------------------------------------------------------
+// HeapQueue::Front
+// 	Return the front of the first band that has a thread in it.
+//----------------------------------------------------------------------
+
+Thread *
+HeapQueue::Front()
+{
+    for (int i = 0; i < 3; i++) {
+        if (!bands[i]->IsEmpty())
+            return bands[i]->Min();
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// ListOf
+// 	Return the list of the priority array a thread goes on.
+//----------------------------------------------------------------------
+
+static int
+ListOf(int priority)
+{
+    return (priority < kernel->schedParams->l2Floor) ? 0 : priority;
+}
+
+//----------------------------------------------------------------------
+// PriorityArrayQueue::PriorityArrayQueue
+// 	Initialize an empty priority array.
+//
+// PriorityArrayQueue::~PriorityArrayQueue
+// 	De-allocate it; the threads are the caller's.
+//----------------------------------------------------------------------
+
+PriorityArrayQueue::PriorityArrayQueue()
+{
+    int i;
+
+    l1 = new Heap<Thread *>(L1Compare, SetReadyIndex);
+    for (i = 0; i < NumPriorityLists; i++)
+        head[i] = tail[i] = NULL;
+    for (i = 0; i < divRoundUp(NumPriorityLists, BitsInWord); i++)
+        nonEmpty[i] = 0;
+}
+
+PriorityArrayQueue::~PriorityArrayQueue()
+{
+    delete l1;
+}
+
+//----------------------------------------------------------------------
+// PriorityArrayQueue::Append, PriorityArrayQueue::Unlink
+// 	Add a thread to the end of a list, or take it out of one,
+//	keeping the list's bit in nonEmpty up to date.
+//----------------------------------------------------------------------
+
+void
+PriorityArrayQueue::Append(int list, Thread *thread)
+{
+    int bit = NumPriorityLists - 1 - list;
+
+    thread->readyPrev = tail[list];
+    thread->readyNext = NULL;
+    if (tail[list] == NULL)
+        head[list] = thread;
+    else
+        tail[list]->readyNext = thread;
+    tail[list] = thread;
+    nonEmpty[bit / BitsInWord] |= 1U << (bit % BitsInWord);
+}
+
+void
+PriorityArrayQueue::Unlink(int list, Thread *thread)
+{
+    int bit = NumPriorityLists - 1 - list;
+
+    if (thread->readyPrev == NULL)
+        head[list] = thread->readyNext;
+    else
+        thread->readyPrev->readyNext = thread->readyNext;
+    if (thread->readyNext == NULL)
+        tail[list] = thread->readyPrev;
+    else
+        thread->readyNext->readyPrev = thread->readyPrev;
+    thread->readyPrev = thread->readyNext = NULL;
+    if (head[list] == NULL)
+        nonEmpty[bit / BitsInWord] &= ~(1U << (bit % BitsInWord));
+}
+
+//----------------------------------------------------------------------
+// PriorityArrayQueue::Insert, PriorityArrayQueue::Remove
+// 	Put a thread at the end of the list for its priority (or into
+//	the L1 heap), or take it out.
+//----------------------------------------------------------------------
+
+void
+PriorityArrayQueue::Insert(Thread *thread)
+{
+    if (ReadyLevel(thread) == 1)
+        l1->Insert(thread);
+    else
+        Append(ListOf(thread->checkPriority()), thread);
+}
+
+void
+PriorityArrayQueue::Remove(Thread *thread)
+{
+    if (ReadyLevel(thread) == 1)
+        l1->Remove(thread->checkReadyIndex());
+    else
+        Unlink(ListOf(thread->checkPriority()), thread);
+}
+
+//----------------------------------------------------------------------
+// PriorityArrayQueue::Changed
+// 	A thread in L2 whose priority has changed moves to the end of
+//	the list for its new priority -- it took its place there just
+//	now.  Nothing in L1 or L3 goes by priority.
+//----------------------------------------------------------------------
+
+void
+PriorityArrayQueue::Changed(Thread *thread, int oldPriority)
+{
+    if (ReadyLevel(thread) == 2) {
+        Unlink(ListOf(oldPriority), thread);
+        Append(ListOf(thread->checkPriority()), thread);
+    }
+}
+
+//----------------------------------------------------------------------
+// PriorityArrayQueue::Front
+// 	Return the front of the L1 heap, or else the front of the
+//	highest priority list that has a thread on it.
+//----------------------------------------------------------------------
+
+Thread *
+PriorityArrayQueue::Front()
+{
+    if (!l1->IsEmpty())
+        return l1->Min();
+    for (int i = 0; i < divRoundUp(NumPriorityLists, BitsInWord); i++) {
+        if (nonEmpty[i] != 0)
+            return head[NumPriorityLists - 1
+				- (i * BitsInWord + FirstSet(nonEmpty[i]))];
+    }
+    return NULL;
+}
@@ -0,0 +1,118 @@
+// readyqueue.h
+//	Data structures for the ready queues of the multi-level feedback
+//	queue scheduler.
+//
+//	A ready thread is in one of three bands, by its priority (these
+//	are the default bands; see schedparams.h): L1 (100-149) is
+//	ordered by t, the estimate of the thread's next CPU burst,
+//	shortest first; L2 (50-99) by priority, highest first; and L3
+//	(0-49) is first come, first served.  Threads that
+//	are otherwise equal go in the order they took their place in the
+//	queue (Thread::checkReadySeq).  The next thread to run is the
+//	first in L1, or if L1 is empty the first in L2, or else the
+//	first in L3.
+//
+//	There are two implementations to choose from at boot (-rq):
+//	three binary heaps, or a priority array -- a FIFO list for each
+//	priority and a bitmap of the lists that aren't empty, as in the
+//	classic O(1) scheduler.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef READYQUEUE_H
+#define READYQUEUE_H
+
+#include "copyright.h"
+#include "heap.h"
+#include "bitmap.h"
+#include "schedparams.h"
+
+class Thread;
+
+// The implementations to choose from (see the -rq flag)
+
+enum ReadyQueueType {
+    HeapReadyQueue,		// a binary heap for each band
+    ArrayReadyQueue		// a list per priority, and a bitmap
+};
+
+// Which band a thread belongs in: 1 for L1, 2 for L2, 3 for L3
+
+extern int ReadyLevel(Thread *thread);
+
+// The interface every implementation provides
+
+class ReadyQueue {
+  public:
+    virtual ~ReadyQueue() {}
+
+    virtual void Insert(Thread *thread) = 0;	// put a thread in its place
+    virtual void Remove(Thread *thread) = 0;	// take it out again
+    virtual void Changed(Thread *thread, int oldPriority) = 0;
+						// the thread's priority, and
+						// its sequence number, have
+						// changed, within its band
+    virtual Thread *Front() = 0;		// the next thread to run,
+						// or NULL if there isn't one
+    Thread *RemoveFront();			// take that thread out
+};
+
+// A binary heap for each band: O(log n) to insert, remove or change
+// a thread, and constant time to find the next one.
+
+class HeapQueue : public ReadyQueue {
+  public:
+    HeapQueue();
+    ~HeapQueue();
+
+    void Insert(Thread *thread);
+    void Remove(Thread *thread);
+    void Changed(Thread *thread, int oldPriority);
+    Thread *Front();
+
+  private:
+    Heap<Thread *> *bands[3];	// L1, L2 and L3
+};
+
+// A FIFO list for each priority of L2, and one for all of L3 (which
+// doesn't go by priority), each with a bit saying whether it is
+// empty: constant time to insert, remove or change a thread in L2 or
+// L3, and to find the next one.  L1 goes by t, not priority, so it
+// has a heap of its own.
+//
+// The lists are threaded through the threads themselves
+// (Thread::readyPrev and readyNext), so a thread can be taken out of
+// the middle of one without a search.
+
+// Lists, and bits, are numbered by priority, except that all of L3
+// shares list 0.  There are enough for L2 to reach up to main's
+// priority, wherever the bands are set to start.
+
+const int NumPriorityLists = MainPriority;
+
+class PriorityArrayQueue : public ReadyQueue {
+  public:
+    PriorityArrayQueue();
+    ~PriorityArrayQueue();
+
+    void Insert(Thread *thread);
+    void Remove(Thread *thread);
+    void Changed(Thread *thread, int oldPriority);
+    Thread *Front();
+
+  private:
+    void Append(int list, Thread *thread);	// add to the end of a list
+    void Unlink(int list, Thread *thread);	// take out of a list
+
+    Heap<Thread *> *l1;			// L1, ordered by t
+    Thread *head[NumPriorityLists];	// first thread on each list
+    Thread *tail[NumPriorityLists];	// last thread on each list
+    unsigned int nonEmpty[divRoundUp(NumPriorityLists, BitsInWord)];
+					// bit i set if list
+					// NumPriorityLists-1-i has a thread,
+					// so the highest priority comes first
+};
+
+#endif // READYQUEUE_H
@@ -0,0 +1,160 @@
+// schedparams.cc
+//	Routines to set the tunable parameters of the scheduler, from
+//	the command line or a file.  See schedparams.h for what they are.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "schedparams.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//----------------------------------------------------------------------
+// SchedParams::SchedParams
+// 	Initialize the parameters to their defaults.
+//----------------------------------------------------------------------
+
+SchedParams::SchedParams()
+{
+    agingTicks = 1500;
+    agingStep = 10;
+    maxPriority = 149;
+    l2Floor = 50;
+    l1Floor = 100;
+    timerTicks = TimerTicks;
+    burstWeight = 50;
+}
+
+//----------------------------------------------------------------------
+// SchedParams::Find
+// 	Return the parameter with a given name, or NULL if there is
+//	none.
+//----------------------------------------------------------------------
+
+int *
+SchedParams::Find(char *name)
+{
+    if (strcmp(name, "agingTicks") == 0)
+	return &agingTicks;
+    if (strcmp(name, "agingStep") == 0)
+	return &agingStep;
+    if (strcmp(name, "maxPriority") == 0)
+	return &maxPriority;
+    if (strcmp(name, "l2Floor") == 0)
+	return &l2Floor;
+    if (strcmp(name, "l1Floor") == 0)
+	return &l1Floor;
+    if (strcmp(name, "timerTicks") == 0)
+	return &timerTicks;
+    if (strcmp(name, "burstWeight") == 0)
+	return &burstWeight;
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// SchedParams::Set
+// 	Apply a setting, "name=value".  An unknown name, or a value
+//	that isn't a number, is fatal.
+//----------------------------------------------------------------------
+
+void
+SchedParams::Set(char *setting)
+{
+    char copy[256], name[32], extra;
+    char *equals;
+    int value, *param;
+
+    strncpy(copy, setting, sizeof(copy) - 1);
+    copy[sizeof(copy) - 1] = '\0';
+    equals = strchr(copy, '=');
+    if (equals != NULL)
+	*equals = ' ';
+    if (sscanf(copy, "%31s %d %c", name, &value, &extra) != 2) {
+	cerr << "Bad scheduler setting \"" << setting << "\"\n";
+	ASSERTNOTREACHED();
+    }
+    param = Find(name);
+    if (param == NULL) {
+	cerr << "Unknown scheduler parameter " << name << "\n";
+	ASSERTNOTREACHED();
+    }
+    DEBUG(dbgThread, "Scheduler parameter " << name << " = " << value);
+    *param = value;
+}
+
+//----------------------------------------------------------------------
+// SchedParams::Load
+// 	Apply each setting in a file, one to a line.  Blank lines, and
+//	anything after a "#", are ignored.
+//----------------------------------------------------------------------
+
+void
+SchedParams::Load(char *fileName)
+{
+    FILE *file = fopen(fileName, "r");
+    char line[256];
+
+    if (file == NULL) {
+	cerr << "Can't open scheduler settings " << fileName << "\n";
+	ASSERTNOTREACHED();
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+	char *comment = strchr(line, '#');
+
+	if (comment != NULL)
+	    *comment = '\0';
+	if (strspn(line, " \t\r\n") == strlen(line))
+	    continue;
+	line[strcspn(line, "\r\n")] = '\0';
+	Set(line);
+    }
+    fclose(file);
+}
+
+//----------------------------------------------------------------------
+// SchedParams::Check
+// 	Make sure the settings make sense together: the bands must be
+//	in order, with room in each, and aging must stop short of main.
+//----------------------------------------------------------------------
+
+void
+SchedParams::Check()
+{
+    if (!(0 <= l2Floor && l2Floor < l1Floor && l1Floor <= maxPriority
+	  && maxPriority < MainPriority)) {
+	cerr << "Need 0 <= l2Floor < l1Floor <= maxPriority < "
+	     << MainPriority << "\n";
+	ASSERTNOTREACHED();
+    }
+    if (agingTicks < 1 || agingStep < 0 || timerTicks < 1
+	|| burstWeight < 0 || burstWeight > 100) {
+	cerr << "Need agingTicks >= 1, agingStep >= 0, timerTicks >= 1, "
+	     << "and 0 <= burstWeight <= 100\n";
+	ASSERTNOTREACHED();
+    }
+}
+
+//----------------------------------------------------------------------
+// SchedParams::IsDefault
+// 	Return TRUE if no setting has changed any parameter from its
+//	default.
+//----------------------------------------------------------------------
+
+bool
+SchedParams::IsDefault()
+{
+    SchedParams defaults;
+
+    return agingTicks == defaults.agingTicks
+	&& agingStep == defaults.agingStep
+	&& maxPriority == defaults.maxPriority
+	&& l2Floor == defaults.l2Floor
+	&& l1Floor == defaults.l1Floor
+	&& timerTicks == defaults.timerTicks
+	&& burstWeight == defaults.burstWeight;
+}
@@ -0,0 +1,60 @@
+// schedparams.h
+//	Data structures for the tunable parameters of the multi-level
+//	feedback queue scheduler, and of the timer that time-slices it.
+//
+//	Each parameter has a name, and is set at boot from the command
+//	line, "-sc name=value", or from a file of such settings,
+//	"-scf file", one to a line ("name=value" or "name value"; a
+//	"#" starts a comment).  Settings are applied in the order given,
+//	so a later one overrides an earlier one.  The defaults are the
+//	scheduler's usual behavior:
+//
+//	  agingTicks   1500  a thread that has waited this long in a
+//			     ready queue has its priority raised
+//	  agingStep      10  by this much
+//	  maxPriority   149  but no higher than this
+//	  l2Floor        50  the lowest priority in L2 (below it is L3)
+//	  l1Floor       100  the lowest priority in L1
+//	  timerTicks    100  (average) ticks between timer interrupts,
+//			     so the time slice of L3
+//	  burstWeight    50  the percentage of the estimate of the next
+//			     CPU burst (t) that comes from the burst just
+//			     run; the rest comes from the old estimate
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDPARAMS_H
+#define SCHEDPARAMS_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// No thread but main may reach this priority, so main is never
+// preempted by MLFQ.
+
+const int MainPriority = 150;
+
+class SchedParams {
+  public:
+    SchedParams();		// the defaults
+
+    void Set(char *setting);	// apply a "name=value" setting
+    void Load(char *fileName);	// apply each setting in a file
+    void Check();		// are the settings consistent?
+    bool IsDefault();		// are they all still the defaults?
+
+    int agingTicks;
+    int agingStep;
+    int maxPriority;
+    int l2Floor;
+    int l1Floor;
+    int timerTicks;
+    int burstWeight;
+
+  private:
+    int *Find(char *name);	// the parameter called "name", or NULL
+};
+
+#endif // SCHEDPARAMS_H
@@ -0,0 +1,680 @@
+// schedpolicy.cc
+//	Routines for the scheduling policies: which ready thread runs
+//	next, and when the running thread should give up the CPU.  See
+//	schedpolicy.h for the policies.
+//
+// 	These routines assume that interrupts are already disabled.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "schedpolicy.h"
+#include "main.h"
+#include <algorithm>
+#include <vector>
+
+//----------------------------------------------------------------------
+// ReadyOrder
+// 	The order of the ready threads: L1 before L2 before L3, and in
+//	each queue, front to back.  L1 is kept sorted by t, L2 by
+//	priority (highest first), and L3 is FIFO; threads that are
+//	otherwise equal go in the order they took their place.
+//----------------------------------------------------------------------
+
+static bool
+ReadyOrder(Thread *th1, Thread *th2)
+{
+    int level = ReadyLevel(th1);
+
+    if (level != ReadyLevel(th2))
+        return level < ReadyLevel(th2);
+    if (level == 1 && th1->checkT() != th2->checkT())
+        return th1->checkT() < th2->checkT();
+    if (level == 2 && th1->checkPriority() != th2->checkPriority())
+        return th1->checkPriority() > th2->checkPriority();
+    return th1->checkReadySeq() < th2->checkReadySeq();
+}
+
+//----------------------------------------------------------------------
+// AgingCompare, SetAgingIndex
+// 	Order the aging heap by when each thread last had its place in a
+//	ready queue set, and keep track of where each thread is in it.
+//----------------------------------------------------------------------
+
+static int
+AgingCompare(Thread *th1, Thread *th2)
+{
+    if (th1->checkLastInQueueTick() != th2->checkLastInQueueTick())
+        return (th1->checkLastInQueueTick() < th2->checkLastInQueueTick()) ? -1 : 1;
+    if (th1->checkReadySeq() != th2->checkReadySeq())
+        return (th1->checkReadySeq() < th2->checkReadySeq()) ? -1 : 1;
+    return 0;
+}
+
+static void
+SetAgingIndex(Thread *thread, int index)
+{
+    thread->setAgingIndex(index);
+}
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::SetPriority
+// 	Change the priority of a ready thread.  A policy that orders its
+//	ready threads by a key set when they become ready (all but MLFQ)
+//	leaves the thread where it is: the new priority counts from the
+//	next time it does.
+//----------------------------------------------------------------------
+
+void
+SchedulingPolicy::SetPriority(Thread *thread, int priority)
+{
+    thread->setPriority(priority);
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::MLFQPolicy
+// 	Initialize empty ready queues.  The thread that is running now
+//	(main) wasn't picked from L3, but is time-sliced all the same.
+//
+//	"type" -- how to keep the ready queue (see readyqueue.h)
+//----------------------------------------------------------------------
+
+MLFQPolicy::MLFQPolicy(ReadyQueueType type)
+{
+    switch (type) {
+      case HeapReadyQueue:
+        readyQueue = new HeapQueue();
+        break;
+      case ArrayReadyQueue:
+        readyQueue = new PriorityArrayQueue();
+        break;
+      default:
+        ASSERTNOTREACHED();
+    }
+    params = kernel->schedParams;
+    agingHeap = new Heap<Thread *>(AgingCompare, SetAgingIndex);
+    nextReadySeq = 0;
+    enablePreemptOnce = FALSE;
+    sliced = TRUE;
+}
+
+MLFQPolicy::~MLFQPolicy()
+{
+    delete readyQueue;
+    delete agingHeap;
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::UpdateRunningT
+// 	Another thread may now go ahead of the running one: update t,
+//	the estimate of the running thread's burst, from what it has
+//	run so far, and check on the next tick whether it should yield.
+//	The new estimate is burstWeight percent of the burst so far, and
+//	the rest of the old estimate; each part is rounded down, so the
+//	default of 50 gives tempTick/2 + t/2.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::UpdateRunningT()
+{
+    Thread *current = kernel->currentThread;
+
+    current->setT(current->checkTempTick() * params->burstWeight / 100
+                  + current->checkT() * (100 - params->burstWeight) / 100);
+    enablePreemptOnce = TRUE;
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Wakeup
+// 	A thread other than the running one is becoming ready.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::Wakeup(Thread * /* thread */)
+{
+    UpdateRunningT();
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Enqueue
+// 	Put a thread at its place in its band, and start it waiting to
+//	be aged.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::Enqueue(Thread *thread)
+{
+    thread->setLastInQueueTick(kernel->stats->totalTicks);
+    thread->setReadySeq(nextReadySeq++);
+    agingHeap->Insert(thread);
+
+    kernel->schedTrace->Record(kernel->stats->totalTicks, TraceInsert,
+                               thread->getID(), ReadyLevel(thread), 0, 0);
+    thread->statistics->EnterQueue(ReadyLevel(thread), kernel->stats->totalTicks);
+    readyQueue->Insert(thread);
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::SetPriority
+// 	Move a ready thread to its place for a new priority, in another
+//	band if it has moved to one, as aging does (see Tick); its wait
+//	to be aged goes on.  Then check whether it should preempt the
+//	running thread.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::SetPriority(Thread *thread, int priority)
+{
+    int now = kernel->stats->totalTicks;
+    int level = ReadyLevel(thread);
+
+    kernel->schedTrace->Record(now, TracePriority, thread->getID(), level,
+                               thread->checkPriority(), priority);
+    readyQueue->Remove(thread);
+    thread->setPriority(priority);
+    if (ReadyLevel(thread) != level) {
+        thread->setReadySeq(nextReadySeq++);
+        kernel->schedTrace->Record(now, TraceRemove, thread->getID(), level, 0, 0);
+        kernel->schedTrace->Record(now, TraceInsert, thread->getID(), ReadyLevel(thread), 0, 0);
+        thread->statistics->LeaveQueue(now);
+        thread->statistics->EnterQueue(ReadyLevel(thread), now);
+    }
+    readyQueue->Insert(thread);
+    UpdateRunningT();
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::PickNext
+// 	Take the first thread of the highest band out of the ready
+//	queue.  The alarm only time-slices threads from L3.
+//----------------------------------------------------------------------
+
+Thread *
+MLFQPolicy::PickNext()
+{
+    Thread *thread = readyQueue->RemoveFront();
+
+    if (thread == NULL)
+        return NULL;
+    agingHeap->Remove(thread->checkAgingIndex());
+    sliced = (ReadyLevel(thread) == 3);
+    thread->statistics->LeaveQueue(kernel->stats->totalTicks);
+    kernel->schedTrace->Record(kernel->stats->totalTicks, TraceRemove,
+                               thread->getID(), ReadyLevel(thread), 0, 0);
+    return thread;
+}
+
+Thread *
+MLFQPolicy::Peek()
+{
+    return readyQueue->Front();
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::NextEventTick
+// 	Return now if there is a preemption check to do, or else the
+//	first tick at which a ready thread will have waited agingTicks
+//	ticks in a ready queue, or -1 if there are no ready threads.
+//----------------------------------------------------------------------
+
+int
+MLFQPolicy::NextEventTick()
+{
+    if (enablePreemptOnce)
+        return kernel->stats->totalTicks;
+    if (agingHeap->IsEmpty())
+        return -1;
+    return agingHeap->Min()->checkLastInQueueTick() + params->agingTicks;
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Tick
+// 	Add agingStep to the priority of each ready thread that has
+//	waited agingTicks ticks since it took its place in a ready queue
+//	(up to maxPriority, or where it is, if that is higher), and start
+//	it waiting again.  A thread aged past the bottom of the queue
+//	above moves up to that queue, and we check whether it should
+//	preempt the running thread.  A thread running on an inherited
+//	priority ages its own priority too, so it keeps what it earned
+//	when the lock is released.
+//
+//	The threads that are due come off the front of the aging heap,
+//	so a tick when nobody is due costs nothing.  They are handled
+//	in queue order (see ReadyOrder), which keeps the printed trace,
+//	and the ready queues, just as if every queue had been scanned.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::Tick()
+{
+    int now = kernel->stats->totalTicks;
+    std::vector<Thread *> due;
+
+    while (!agingHeap->IsEmpty()
+           && now - agingHeap->Min()->checkLastInQueueTick() >= params->agingTicks)
+        due.push_back(agingHeap->RemoveMin());
+    if (due.empty())
+        return;
+    std::sort(due.begin(), due.end(), ReadyOrder);
+
+    for (unsigned int i = 0; i < due.size(); i++) {
+        Thread *temp = due[i];
+        int level = ReadyLevel(temp);
+        int addedPriority = temp->checkPriority() + params->agingStep;
+
+        // aging caps a priority at maxPriority, but never lowers one
+        // that started above it (with -ep, say)
+        addedPriority = min(addedPriority,
+                            max(params->maxPriority, temp->checkPriority()));
+        if (temp->checkBasePriority() >= 0) {
+            int base = temp->checkBasePriority();
+
+            temp->setBasePriority(min(base + params->agingStep,
+                                      max(params->maxPriority, base)));
+        }
+        kernel->schedTrace->Record(now, TracePriority, temp->getID(), level,
+                                   temp->checkPriority(), addedPriority);
+        if ((level == 2 && addedPriority >= params->l1Floor)
+            || (level == 3 && addedPriority >= params->l2Floor)) {
+            UpdateRunningT();
+            readyQueue->Remove(temp);
+            temp->setPriority(addedPriority);
+            temp->setReadySeq(nextReadySeq++);
+            readyQueue->Insert(temp);
+            kernel->schedTrace->Record(now, TraceRemove, temp->getID(), level, 0, 0);
+            kernel->schedTrace->Record(now, TraceInsert, temp->getID(), ReadyLevel(temp), 0, 0);
+            temp->statistics->LeaveQueue(now);
+            temp->statistics->EnterQueue(ReadyLevel(temp), now);
+            temp->statistics->numPromotions++;
+        } else {
+            int oldPriority = temp->checkPriority();
+
+            temp->setPriority(addedPriority);
+            if (level == 2)			// it moves ahead of
+                temp->setReadySeq(nextReadySeq++);	// the threads it
+            readyQueue->Changed(temp, oldPriority);	// now ties with
+        }
+        temp->setLastInQueueTick(now);
+        agingHeap->Insert(temp);
+    }
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::ShouldPreempt
+// 	If a thread has become ready, or moved up a band, since the last
+//	tick, should it preempt the running thread?  A thread in a higher
+//	band preempts one in a lower band; within L2 a higher priority
+//	preempts, and within L1 a smaller t.  main (MainPriority) is
+//	never preempted.
+//----------------------------------------------------------------------
+
+bool
+MLFQPolicy::ShouldPreempt()
+{
+    Thread *current = kernel->currentThread;
+    Thread *candidate;
+    bool preempt = FALSE;
+
+    if (!enablePreemptOnce)
+        return FALSE;
+    enablePreemptOnce = FALSE;
+
+    candidate = readyQueue->Front();
+    if (candidate != NULL && current->checkPriority() != MainPriority) {
+        int l2 = params->l2Floor, l1 = params->l1Floor;
+
+        if (candidate->checkPriority() >= l2 && candidate->checkPriority() < l1) { // if candidate is in L2...
+            if (current->checkPriority() < l2) preempt = TRUE; // L3 is preempted by L2
+            else if (current->checkPriority() < l1) {
+                if (candidate->checkPriority() > current->checkPriority()) preempt = TRUE; // both L2, but candidate's priority is higher
+            }
+        } else if (candidate->checkPriority() >= l1 && candidate->checkPriority() < MainPriority) { // if candidate is in L1...
+            if (current->checkPriority() < l1) preempt = TRUE; // L2 and L3 are preempted by L1
+            else {
+                if (candidate->checkT() < current->checkT()) preempt = TRUE; // both L1, but candidate's t is smaller
+            }
+        }
+    }
+    return preempt;
+}
+
+//----------------------------------------------------------------------
+// ThreadKeyCompare
+// 	Order the ready threads of a KeyedPolicy by key; threads with the
+//	same key go in the order they became ready.
+//----------------------------------------------------------------------
+
+static int
+ThreadKeyCompare(Thread *th1, Thread *th2)
+{
+    if (th1->checkSchedKey() != th2->checkSchedKey())
+        return (th1->checkSchedKey() < th2->checkSchedKey()) ? -1 : 1;
+    if (th1->checkReadySeq() != th2->checkReadySeq())
+        return (th1->checkReadySeq() < th2->checkReadySeq()) ? -1 : 1;
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// KeyedPolicy::KeyedPolicy
+// 	Initialize an empty ready tree.  Nothing is charged for the CPU
+//	until the first thread is picked.
+//----------------------------------------------------------------------
+
+KeyedPolicy::KeyedPolicy(TraceKey key)
+{
+    readyTree = new RBTree<Thread *>(ThreadKeyCompare);
+    running = NULL;
+    lastCharge = 0;
+    nextReadySeq = 0;
+    checkWakeup = FALSE;
+    this->key = key;
+}
+
+KeyedPolicy::~KeyedPolicy()
+{
+    delete readyTree;
+}
+
+//----------------------------------------------------------------------
+// KeyedPolicy::Update
+// 	Charge the running thread for the ticks since it was last
+//	charged.
+//----------------------------------------------------------------------
+
+void
+KeyedPolicy::Update()
+{
+    int now = kernel->stats->totalTicks;
+
+    if (running != NULL && now > lastCharge)
+        Charge(running, now - lastCharge);
+    lastCharge = now;
+}
+
+//----------------------------------------------------------------------
+// KeyedPolicy::LeastKey
+// 	Return the smallest key of the running thread and the ready
+//	threads, or -1 if the CPU is idle and nobody is ready.
+//----------------------------------------------------------------------
+
+long long
+KeyedPolicy::LeastKey()
+{
+    long long least = -1;
+
+    if (running != NULL)
+        least = running->checkSchedKey();
+    if (!readyTree->IsEmpty()
+        && (least < 0 || readyTree->Min()->checkSchedKey() < least))
+        least = readyTree->Min()->checkSchedKey();
+    return least;
+}
+
+//----------------------------------------------------------------------
+// KeyedPolicy::Behind
+// 	Is the running thread's key more than a granularity ahead of
+//	the first ready thread's?
+//----------------------------------------------------------------------
+
+bool
+KeyedPolicy::Behind()
+{
+    if (running == NULL || running != kernel->currentThread
+        || readyTree->IsEmpty())
+        return FALSE;
+    return readyTree->Min()->checkSchedKey() + Granularity()
+        < running->checkSchedKey();
+}
+
+//----------------------------------------------------------------------
+// KeyedPolicy::Wakeup
+// 	A thread other than the running one is becoming ready: give it
+//	its key, and check on the next tick whether it should preempt
+//	the running thread.
+//----------------------------------------------------------------------
+
+void
+KeyedPolicy::Wakeup(Thread *thread)
+{
+    Update();
+    Release(thread);
+    checkWakeup = TRUE;
+}
+
+//----------------------------------------------------------------------
+// KeyedPolicy::Enqueue
+// 	Put a thread into the ready tree, by its key.
+//----------------------------------------------------------------------
+
+void
+KeyedPolicy::Enqueue(Thread *thread)
+{
+    thread->setReadySeq(nextReadySeq++);
+    readyTree->Insert(thread);
+    thread->statistics->EnterQueue(0, kernel->stats->totalTicks);
+    kernel->schedTrace->Record(kernel->stats->totalTicks, TraceInsert,
+                               thread->getID(), 0, key, thread->checkSchedKey());
+}
+
+//----------------------------------------------------------------------
+// KeyedPolicy::PickNext
+// 	Charge the thread that is giving up the CPU, and take the ready
+//	thread with the smallest key out of the tree.  If there isn't
+//	one, the running thread carries on, unless it is going to sleep.
+//----------------------------------------------------------------------
+
+Thread *
+KeyedPolicy::PickNext()
+{
+    Thread *thread;
+
+    Update();
+    if (readyTree->IsEmpty()) {
+        if (kernel->currentThread->getStatus() != RUNNING)
+            running = NULL;
+        return NULL;
+    }
+    thread = readyTree->RemoveMin();
+    thread->statistics->LeaveQueue(kernel->stats->totalTicks);
+    running = thread;
+    kernel->schedTrace->Record(kernel->stats->totalTicks, TraceRemove,
+                               thread->getID(), 0, 0, 0);
+    return thread;
+}
+
+Thread *
+KeyedPolicy::Peek()
+{
+    if (readyTree->IsEmpty())
+        return NULL;
+    return readyTree->Min();
+}
+
+//----------------------------------------------------------------------
+// KeyedPolicy::ShouldPreempt, KeyedPolicy::SliceOver
+// 	Should the running thread give way to the first ready thread --
+//	on the tick after a thread has become ready, or at a timer
+//	interrupt?
+//----------------------------------------------------------------------
+
+bool
+KeyedPolicy::ShouldPreempt()
+{
+    if (!checkWakeup)
+        return FALSE;
+    checkWakeup = FALSE;
+    Update();
+    return Behind();
+}
+
+bool
+KeyedPolicy::SliceOver()
+{
+    Update();
+    return Behind();
+}
+
+//----------------------------------------------------------------------
+// KeyedPolicy::WantsTimer
+// 	The running thread can only fall behind at a timer interrupt if
+//	there is a ready thread for it to fall behind.
+//----------------------------------------------------------------------
+
+bool
+KeyedPolicy::WantsTimer()
+{
+    return !readyTree->IsEmpty();
+}
+
+//----------------------------------------------------------------------
+// KeyedPolicy::NextEventTick
+// 	Only a preemption check after a wakeup happens on a tick.
+//----------------------------------------------------------------------
+
+int
+KeyedPolicy::NextEventTick()
+{
+    return checkWakeup ? kernel->stats->totalTicks : -1;
+}
+
+//----------------------------------------------------------------------
+// ClampPriority
+// 	The priority of a thread, within 0-149 (main has 150).
+//----------------------------------------------------------------------
+
+static int
+ClampPriority(Thread *thread)
+{
+    int priority = thread->checkPriority();
+
+    if (priority < 0)
+        return 0;
+    if (priority > 149)
+        return 149;
+    return priority;
+}
+
+// The weight of each nice level, -20 to 19, from Linux: each is about
+// 1.25 times the next.
+
+static const int niceToWeight[40] = {
+    88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+    9548, 7620, 6100, 4904, 3906, 3121, 2501, 1991, 1586, 1277,
+    1024, 820, 655, 526, 423, 335, 272, 215, 172, 137,
+    110, 87, 70, 56, 45, 36, 29, 23, 18, 15
+};
+
+//----------------------------------------------------------------------
+// FairWeight
+// 	The weight of a thread, by its priority: 0 is nice 19, 75 nice
+//	0, and 149 nice -20.
+//----------------------------------------------------------------------
+
+static int
+FairWeight(Thread *thread)
+{
+    int nice = 20 - (ClampPriority(thread) + 1) * 40 / 150;
+
+    if (nice > 19)
+        nice = 19;
+    return niceToWeight[nice + 20];
+}
+
+FairPolicy::FairPolicy()
+    : KeyedPolicy(TraceVruntime)
+{
+    minVruntime = 0;
+}
+
+//----------------------------------------------------------------------
+// FairPolicy::Release
+// 	A thread becoming ready starts at the least virtual runtime, if
+//	it is further back than that.
+//----------------------------------------------------------------------
+
+void
+FairPolicy::Release(Thread *thread)
+{
+    long long least = LeastKey();
+
+    if (least > minVruntime)
+        minVruntime = least;
+    if (thread->checkSchedKey() < minVruntime)
+        thread->setSchedKey(minVruntime);
+}
+
+void
+FairPolicy::Charge(Thread *thread, int ticks)
+{
+    thread->setSchedKey(thread->checkSchedKey()
+                        + (long long) ticks * NiceZeroWeight / FairWeight(thread));
+}
+
+StridePolicy::StridePolicy()
+    : KeyedPolicy(TracePass)
+{
+    globalPass = 0;
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::Release
+// 	A thread becoming ready starts at the global pass, if it is
+//	behind it.
+//----------------------------------------------------------------------
+
+void
+StridePolicy::Release(Thread *thread)
+{
+    long long least = LeastKey();
+
+    if (least > globalPass)
+        globalPass = least;
+    if (thread->checkSchedKey() < globalPass)
+        thread->setSchedKey(globalPass);
+}
+
+void
+StridePolicy::Charge(Thread *thread, int ticks)
+{
+    int tickets = ClampPriority(thread) + 1;
+
+    thread->setSchedKey(thread->checkSchedKey() + ticks * (StrideOne / tickets));
+}
+
+//----------------------------------------------------------------------
+// RelativeDeadline
+// 	How soon a thread should run after becoming ready, by its
+//	priority.
+//----------------------------------------------------------------------
+
+static int
+RelativeDeadline(Thread *thread)
+{
+    return DeadlineBase + (149 - ClampPriority(thread)) * DeadlineStep;
+}
+
+DeadlinePolicy::DeadlinePolicy()
+    : KeyedPolicy(TraceDeadline)
+{
+}
+
+void
+DeadlinePolicy::Release(Thread *thread)
+{
+    thread->setSchedKey(kernel->stats->totalTicks + RelativeDeadline(thread));
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::Charge
+// 	A thread still running at its deadline is given the next one.
+//----------------------------------------------------------------------
+
+void
+DeadlinePolicy::Charge(Thread *thread, int /* ticks */)
+{
+    while (thread->checkSchedKey() <= kernel->stats->totalTicks)
+        thread->setSchedKey(thread->checkSchedKey() + RelativeDeadline(thread));
+}
@@ -0,0 +1,242 @@
+// schedpolicy.h
+//	Data structures for the scheduling policies.
+//
+//	The scheduler (scheduler.h) does the dispatching -- it switches
+//	from one thread to the next -- but leaves it to a policy to
+//	decide which ready thread runs next, and when the running thread
+//	should give up the CPU.  The policy is told each time a thread
+//	becomes ready, asked for the next thread to run, and called on
+//	every tick and at every timer interrupt.
+//
+//	There are four policies to choose from at boot (-sp):
+//
+//	  mlfq	  the multi-level feedback queue: three bands by priority,
+//		  with aging (see readyqueue.h); the default
+//	  cfs	  completely fair: the thread that has had the least CPU
+//		  time, weighted by its priority, runs next
+//	  stride  stride scheduling: each thread holds tickets in
+//		  proportion to its priority, and gets that share of
+//		  the CPU
+//	  edf	  earliest deadline first: a thread must run within a
+//		  time set by its priority of becoming ready
+//
+//	All of them take a thread's priority from Thread::checkPriority,
+//	so the same workload (-ep) runs under any of them.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDPOLICY_H
+#define SCHEDPOLICY_H
+
+#include "copyright.h"
+#include "heap.h"
+#include "rbtree.h"
+#include "readyqueue.h"
+#include "schedparams.h"
+#include "schedtrace.h"
+
+class Thread;
+
+// The policies to choose from (see the -sp flag)
+
+enum SchedulingPolicyType {
+    MLFQScheduling,		// multi-level feedback queue
+    FairScheduling,		// least weighted CPU time first
+    StrideScheduling,		// proportional share, by tickets
+    DeadlineScheduling		// earliest deadline first
+};
+
+// The interface every policy provides.  All of these are called with
+// interrupts off.
+
+class SchedulingPolicy {
+  public:
+    virtual ~SchedulingPolicy() {}
+
+    virtual void Wakeup(Thread *thread) {}
+				// a thread other than the running one
+				// is about to be enqueued: it was just
+				// created, or has stopped waiting
+    virtual void Enqueue(Thread *thread) = 0;
+				// put a ready thread in the ready queue
+    virtual void SetPriority(Thread *thread, int priority);
+				// change the priority of a thread in the
+				// ready queue; by default, it keeps its
+				// place until it is next enqueued
+    virtual Thread *PickNext() = 0;
+				// take the next thread to run out of the
+				// ready queue, or return NULL if it is
+				// empty; the running thread is about to
+				// give up the CPU (or has already)
+    virtual Thread *Peek() = 0;	// the same, without taking it out
+
+    virtual void Tick() {}	// called on every tick
+    virtual bool ShouldPreempt() { return FALSE; }
+				// called on every tick, after Tick:
+				// should the running thread yield now?
+    virtual bool SliceOver() { return FALSE; }
+				// called at every timer interrupt: has
+				// the running thread used up its slice?
+    virtual bool WantsTimer() { return FALSE; }
+				// might SliceOver say so at the next
+				// timer interrupt?  If not, the timer is
+				// turned off until a thread is dispatched
+				// or becomes ready
+    virtual int NextEventTick() { return -1; }
+				// the first tick at which Tick or
+				// ShouldPreempt might have something to
+				// do, or -1 if none ever will until
+				// another thread becomes ready
+};
+
+// The multi-level feedback queue.  A thread becoming ready, or being
+// aged into a higher band, prompts a check on the next tick of whether
+// it should preempt the running thread; only threads picked from L3
+// are time-sliced.  The bands, aging and burst estimate are tuned by
+// the kernel's SchedParams (see schedparams.h).
+
+class MLFQPolicy : public SchedulingPolicy {
+  public:
+    MLFQPolicy(ReadyQueueType type);	// "type" -- how to keep the
+					// ready queue
+    ~MLFQPolicy();
+
+    void Wakeup(Thread *thread);
+    void Enqueue(Thread *thread);
+    void SetPriority(Thread *thread, int priority);
+    Thread *PickNext();
+    Thread *Peek();
+
+    void Tick();		// age the threads that are due
+    bool ShouldPreempt();
+    bool SliceOver() { return sliced; }
+    bool WantsTimer() { return sliced; }
+    int NextEventTick();
+
+  private:
+    void UpdateRunningT();	// update t of the running thread, and
+				// ask for a preemption check
+
+    SchedParams *params;	// how to age threads, and estimate bursts
+    ReadyQueue *readyQueue;	// threads that are ready to run, but not
+				// running, in L1, L2 and L3
+    Heap<Thread *> *agingHeap;	// the same threads, the one due for
+				// aging first at the front
+    int nextReadySeq;		// to order threads with equal keys
+    bool enablePreemptOnce;	// check for preemption on the next tick
+    bool sliced;		// is the running thread time-sliced?
+};
+
+// The other three policies all run the ready thread with the smallest
+// key (Thread::checkSchedKey) -- its virtual runtime, pass or deadline
+// -- and keep the ready threads in a red-black tree ordered by it.  A
+// policy says how a thread's key is set when it becomes ready, and how
+// it moves on as the thread runs; the running thread is preempted
+// when another thread's key is more than a granularity below its own,
+// checked when a thread becomes ready and at every timer interrupt.
+
+class KeyedPolicy : public SchedulingPolicy {
+  public:
+    KeyedPolicy(TraceKey key);	// "key" -- what the key is, for the
+				// trace
+    virtual ~KeyedPolicy();
+
+    void Wakeup(Thread *thread);
+    void Enqueue(Thread *thread);
+    Thread *PickNext();
+    Thread *Peek();
+
+    bool ShouldPreempt();
+    bool SliceOver();
+    bool WantsTimer();
+    int NextEventTick();
+
+  protected:
+    virtual void Release(Thread *thread) = 0;
+				// set the key of a thread becoming ready
+    virtual void Charge(Thread *thread, int ticks) = 0;
+				// move the key of a thread on, after it
+				// has had the CPU for "ticks" ticks
+    virtual int Granularity() { return 0; }
+				// how far ahead the running thread's key
+				// may get before it is preempted
+    long long LeastKey();	// the smallest key of the running and
+				// ready threads, or -1 if there are none
+
+  private:
+    void Update();		// charge the running thread up to now
+    bool Behind();		// should the running thread be preempted?
+
+    RBTree<Thread *> *readyTree;// the ready threads, smallest key first
+    Thread *running;		// the thread being charged for the CPU,
+				// or NULL if it is idle
+    int lastCharge;		// when it was last charged
+    int nextReadySeq;		// to order threads with equal keys
+    bool checkWakeup;		// check for preemption on the next tick
+    TraceKey key;		// what the key is
+};
+
+// Completely fair scheduling: the key is the thread's virtual runtime,
+// the ticks it has run scaled by NiceZeroWeight / its weight.  The
+// weights go up by a quarter for every four or so points of priority,
+// as with the forty nice levels of Linux.  A thread that becomes ready
+// starts no further back than the least virtual runtime, so sleeping
+// doesn't bank CPU time.
+
+const int NiceZeroWeight = 1024;	// weight of a priority 75 thread
+const int FairGranularity = 50;		// in ticks of a priority 75 thread
+
+class FairPolicy : public KeyedPolicy {
+  public:
+    FairPolicy();
+
+  protected:
+    void Release(Thread *thread);
+    void Charge(Thread *thread, int ticks);
+    int Granularity() { return FairGranularity; }
+
+  private:
+    long long minVruntime;	// never goes backwards
+};
+
+// Stride scheduling: a thread of priority p holds p+1 tickets, and its
+// key is its pass, which moves on by StrideOne / tickets for each tick
+// it runs.  So shares are in proportion to tickets, not geometric as
+// with FairPolicy.  A thread that becomes ready starts at the global
+// pass (the least pass) if it is behind.
+
+const long long StrideOne = 1 << 20;
+
+class StridePolicy : public KeyedPolicy {
+  public:
+    StridePolicy();
+
+  protected:
+    void Release(Thread *thread);
+    void Charge(Thread *thread, int ticks);
+
+  private:
+    long long globalPass;	// never goes backwards
+};
+
+// Earliest deadline first: the key is the tick by which the thread
+// should have run, set when it becomes ready to that tick plus its
+// relative deadline -- DeadlineBase ticks for priority 149, and
+// DeadlineStep more for each point less.  A thread that runs past its
+// deadline is given the next one, a relative deadline later.
+
+const int DeadlineBase = 100;
+const int DeadlineStep = 10;
+
+class DeadlinePolicy : public KeyedPolicy {
+  public:
+    DeadlinePolicy();
+
+  protected:
+    void Release(Thread *thread);
+    void Charge(Thread *thread, int ticks);
+};
+
+#endif // SCHEDPOLICY_H
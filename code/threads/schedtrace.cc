@@ -0,0 +1,248 @@
+// schedtrace.cc
+//	Routines to record the scheduler's events, write them to a trace
+//	file, and decode a trace file.  See schedtrace.h.
+//
+//	A trace file is a header -- TraceMagic, TraceVersion and the size
+//	of a record -- followed by the records, oldest first, in the
+//	host's byte order.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "sysdep.h"
+#include "schedtrace.h"
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <vector>
+
+static const int TraceMagic = 0x4e545243;	// "NTRC"
+static const int TraceVersion = 1;
+static char DefaultTraceFile[] = "schedtrace";
+
+static const char *traceKeyNames[] = { "vruntime", "pass", "deadline" };
+
+//----------------------------------------------------------------------
+// PrintTraceRecord
+// 	Print an event as a line of the usual scheduler trace.
+//----------------------------------------------------------------------
+
+void
+PrintTraceRecord(TraceRecord *record)
+{
+    switch (record->type) {
+      case TraceInsert:
+	if (record->queue == 0)
+	    printf("Tick %d: Thread %d is inserted into the ready queue, %s %lld\n", record->tick, record->thread, traceKeyNames[record->oldValue], record->newValue);
+	else
+	    printf("Tick %d: Thread %d is inserted into queue L%d\n", record->tick, record->thread, record->queue);
+	break;
+      case TraceRemove:
+	if (record->queue == 0)
+	    printf("Tick %d: Thread %d is removed from the ready queue\n", record->tick, record->thread);
+	else
+	    printf("Tick %d: Thread %d is removed from queue L%d\n", record->tick, record->thread, record->queue);
+	break;
+      case TracePriority:
+	printf("Tick %d: Thread %d changes its priority from %d to %lld\n", record->tick, record->thread, record->oldValue, record->newValue);
+	break;
+      case TraceSelect:
+	printf("Tick %d: Thread %d is now selected for execution\n", record->tick, record->thread);
+	break;
+      case TraceReplace:
+	printf("Tick %d: Thread %d is replaced, and it has executed %d ticks\n", record->tick, record->thread, record->oldValue);
+	break;
+      default:
+	ASSERTNOTREACHED();
+    }
+}
+
+//----------------------------------------------------------------------
+// SchedTrace::SchedTrace
+// 	Set up an empty ring, and create the trace file, if there is to
+//	be one.  Stream mode needs a file; it defaults to "schedtrace".
+//
+//	"mode" -- what to do with events (see schedtrace.h)
+//	"fileName" -- where to write them, or NULL
+//----------------------------------------------------------------------
+
+SchedTrace::SchedTrace(TraceMode mode, char *fileName)
+{
+    int header[3];
+
+    this->mode = mode;
+    ring = new TraceRecord[TraceRingSize];
+    numRecorded = numWritten = 0;
+    fileId = -1;
+    if (mode == TraceStream && fileName == NULL)
+	fileName = DefaultTraceFile;
+    if (mode != TraceText && fileName != NULL) {
+	fileId = OpenForWrite(fileName);
+	header[0] = TraceMagic;
+	header[1] = TraceVersion;
+	header[2] = sizeof(TraceRecord);
+	WriteFile(fileId, (char *) header, sizeof(header));
+    }
+}
+
+//----------------------------------------------------------------------
+// SchedTrace::~SchedTrace
+// 	Write out the events not yet written, and close the trace file.
+//----------------------------------------------------------------------
+
+SchedTrace::~SchedTrace()
+{
+    if (fileId >= 0) {
+	Flush();
+	Close(fileId);
+    }
+    delete [] ring;
+}
+
+//----------------------------------------------------------------------
+// SchedTrace::Flush
+// 	Write the events recorded since the last flush to the trace file,
+//	as far as they are still in the ring: in quiet mode, older ones
+//	have been overwritten.
+//----------------------------------------------------------------------
+
+void
+SchedTrace::Flush()
+{
+    if (fileId < 0)
+	return;
+    if (numRecorded - numWritten > (unsigned int) TraceRingSize)
+	numWritten = numRecorded - TraceRingSize;
+    while (numWritten < numRecorded) {
+	int first = numWritten % TraceRingSize;
+	int count = min((int) (numRecorded - numWritten), TraceRingSize - first);
+
+	WriteFile(fileId, (char *) &ring[first], count * sizeof(TraceRecord));
+	numWritten += count;
+    }
+}
+
+//----------------------------------------------------------------------
+// PrintCsv
+// 	Print the events as comma-separated values, one per line.
+//----------------------------------------------------------------------
+
+static void
+PrintCsv(std::vector<TraceRecord> &records)
+{
+    static const char *typeNames[] = { "insert", "remove", "priority",
+				       "select", "replace" };
+
+    printf("tick,event,thread,queue,old,new\n");
+    for (unsigned int i = 0; i < records.size(); i++) {
+	TraceRecord *r = &records[i];
+
+	printf("%d,%s,%d,%d,%d,%lld\n", r->tick, typeNames[r->type],
+	       r->thread, r->queue, r->oldValue, r->newValue);
+    }
+}
+
+//----------------------------------------------------------------------
+// PrintGantt
+// 	Print a chart of which thread was running when: a row for each
+//	thread, and a column for each GanttWidth'th of the trace, marked
+//	if the thread ran for any of it.  Then list the runs.
+//----------------------------------------------------------------------
+
+static const int GanttWidth = 64;
+
+static void
+PrintGantt(std::vector<TraceRecord> &records)
+{
+    std::map<int, std::vector<int> > runs;	// start and end ticks
+    int running = -1, start = 0;
+    int first, last, perColumn;
+    unsigned int i;
+
+    if (records.empty())
+	return;
+    first = records[0].tick;
+    last = records[records.size() - 1].tick;
+    for (i = 0; i < records.size(); i++) {
+	if (records[i].type != TraceSelect)
+	    continue;
+	if (running >= 0) {
+	    runs[running].push_back(start);
+	    runs[running].push_back(records[i].tick);
+	}
+	running = records[i].thread;
+	start = records[i].tick;
+    }
+    if (running >= 0) {
+	runs[running].push_back(start);
+	runs[running].push_back(last);
+    }
+
+    perColumn = divRoundUp(last - first + 1, GanttWidth);
+    printf("Ticks %d to %d, %d per column\n", first, last, perColumn);
+    for (std::map<int, std::vector<int> >::iterator it = runs.begin();
+	 it != runs.end(); it++) {
+	char row[GanttWidth + 1];
+	std::vector<int> &r = it->second;
+
+	memset(row, '.', GanttWidth);
+	row[GanttWidth] = '\0';
+	for (i = 0; i < r.size(); i += 2) {
+	    for (int col = (r[i] - first) / perColumn;
+		 col <= (r[i + 1] - first) / perColumn && col < GanttWidth; col++)
+		row[col] = '#';
+	}
+	printf("Thread %3d |%s|\n", it->first, row);
+    }
+    for (std::map<int, std::vector<int> >::iterator it = runs.begin();
+	 it != runs.end(); it++) {
+	std::vector<int> &r = it->second;
+
+	printf("Thread %d ran", it->first);
+	for (i = 0; i < r.size(); i += 2)
+	    printf(" %d-%d", r[i], r[i + 1]);
+	printf("\n");
+    }
+}
+
+//----------------------------------------------------------------------
+// DecodeSchedTrace
+// 	Read a trace file, and print its events.
+//
+//	"fileName" -- the trace file
+//	"format" -- "text", "csv" or "gantt"
+//----------------------------------------------------------------------
+
+void
+DecodeSchedTrace(char *fileName, char *format)
+{
+    std::vector<TraceRecord> records;
+    TraceRecord record;
+    int header[3];
+    int fd = OpenForReadWrite(fileName, TRUE);
+
+    if (ReadPartial(fd, (char *) header, sizeof(header)) != sizeof(header)
+	|| header[0] != TraceMagic || header[1] != TraceVersion
+	|| header[2] != sizeof(TraceRecord)) {
+	cerr << fileName << " is not a scheduler trace from this nachos\n";
+	ASSERTNOTREACHED();
+    }
+    while (ReadPartial(fd, (char *) &record, sizeof(record)) == sizeof(record))
+	records.push_back(record);
+    Close(fd);
+
+    if (strcmp(format, "text") == 0) {
+	for (unsigned int i = 0; i < records.size(); i++)
+	    PrintTraceRecord(&records[i]);
+    } else if (strcmp(format, "csv") == 0) {
+	PrintCsv(records);
+    } else if (strcmp(format, "gantt") == 0) {
+	PrintGantt(records);
+    } else {
+	cerr << "Unknown trace format " << format << "\n";
+	ASSERTNOTREACHED();
+    }
+}
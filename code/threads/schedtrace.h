@@ -0,0 +1,136 @@
+// schedtrace.h
+//	Data structures for the scheduler's event trace.
+//
+//	Every time the scheduler puts a thread into a ready queue, takes
+//	one out, changes a priority or switches threads, it records an
+//	event.  What happens to the event depends on the trace mode
+//	(-st):
+//
+//	  text	  print it straight away, as a line of the usual trace
+//		  ("Tick 100: Thread 1 is inserted into queue L1"); the
+//		  default
+//	  quiet	  keep it in a fixed-size ring in memory, overwriting
+//		  the oldest event; the last TraceRingSize events are
+//		  written to the trace file (-stf) at halt
+//	  stream  keep it in the ring, and write the ring out to the
+//		  trace file each time it fills, and at halt, so the
+//		  file has every event
+//
+//	Recording an event in the ring is a handful of stores; nothing
+//	is formatted until the trace file is decoded, offline, with
+//	"nachos -sd <file> text|csv|gantt".  The text decoding is
+//	exactly what text mode would have printed.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDTRACE_H
+#define SCHEDTRACE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// What the trace does with events (see the -st flag)
+
+enum TraceMode {
+    TraceText,			// print each event as it happens
+    TraceQuiet,			// keep the last few in memory
+    TraceStream			// write them all to the trace file
+};
+
+// The kinds of event
+
+enum TraceEventType {
+    TraceInsert,		// a thread went into a ready queue
+    TraceRemove,		// a thread came out of one, to run
+    TracePriority,		// a ready thread's priority changed
+    TraceSelect,		// a thread started running
+    TraceReplace		// and the thread before it stopped
+};
+
+// The ready queue of the CFS, stride and EDF policies is queue 0 (MLFQ
+// has queues 1-3), and an insert into it records the thread's key,
+// which is one of these.
+
+enum TraceKey {
+    TraceVruntime,
+    TracePass,
+    TraceDeadline
+};
+
+// One event, as it is kept in the ring and written to the trace file.
+
+class TraceRecord {
+  public:
+    int tick;			// when it happened
+    short type;			// a TraceEventType
+    short queue;		// which ready queue, for an insert or
+				// remove: 1-3 for L1-L3, 0 otherwise
+    int thread;			// the thread's ID
+    int oldValue;		// the old priority; or for a replace,
+				// the ticks the thread ran; or for an
+				// insert into queue 0, the TraceKey
+    long long newValue;		// the new priority, or the key
+};
+
+const int TraceRingSize = 4096;	// events in the ring; a power of two
+
+// The trace itself
+
+class SchedTrace {
+  public:
+    SchedTrace(TraceMode mode, char *fileName);
+				// "fileName" -- the trace file, or NULL
+				// for none (only for text or quiet mode)
+    ~SchedTrace();		// write out what is left, and close the
+				// trace file
+
+    void Record(int tick, TraceEventType type, int thread, int queue,
+		int oldValue, long long newValue);
+				// record an event
+
+    void Flush();		// write the ring out to the trace file
+
+  private:
+    TraceMode mode;
+    TraceRecord *ring;		// the last TraceRingSize events
+    unsigned int numRecorded;	// events recorded so far; the next
+				// one goes at numRecorded % TraceRingSize
+    unsigned int numWritten;	// events written to the trace file
+    int fileId;			// the trace file, or -1
+};
+
+//----------------------------------------------------------------------
+// SchedTrace::Record
+// 	Record an event: print it, or put it in the ring.  In line, so
+//	that in quiet and stream mode an event costs a few stores.
+//----------------------------------------------------------------------
+
+extern void PrintTraceRecord(TraceRecord *record);
+
+inline void
+SchedTrace::Record(int tick, TraceEventType type, int thread, int queue,
+		   int oldValue, long long newValue)
+{
+    TraceRecord *record = &ring[numRecorded % TraceRingSize];
+
+    record->tick = tick;
+    record->type = type;
+    record->queue = queue;
+    record->thread = thread;
+    record->oldValue = oldValue;
+    record->newValue = newValue;
+    numRecorded++;
+    if (mode == TraceText)
+	PrintTraceRecord(record);
+    else if (mode == TraceStream && numRecorded - numWritten == TraceRingSize)
+	Flush();
+}
+
+// Decode a trace file onto standard output, as text (the usual trace),
+// csv, or a gantt chart of which thread ran when.
+
+extern void DecodeSchedTrace(char *fileName, char *format);
+
+#endif // SCHEDTRACE_H
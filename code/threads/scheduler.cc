@@ -11,8 +11,8 @@
 //	end up calling FindNextToRun(), and that would put us in an 
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	The choice of the next thread is left to a scheduling policy
+//	(see schedpolicy.h).
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -22,30 +22,35 @@
 #include "debug.h"
 #include "scheduler.h"
 #include "main.h"
-#include <stdio.h>
-#include <algorithm>
-
-bool cmpL2(Thread *th1, Thread *th2) {
-    return th1->checkPriority() > th2->checkPriority();
-}
-
-bool cmpL1(Thread *th1, Thread *th2) {
-    return th1->checkT() < th2->checkT();
-}
 
 //----------------------------------------------------------------------
 // Scheduler::Scheduler
 // 	Initialize the list of ready but not running threads.
 //	Initially, no ready threads.
+//
+//	"policyType" -- which scheduling policy to use (see schedpolicy.h)
+//	"queueType" -- how MLFQ keeps its ready queue (see readyqueue.h)
 //----------------------------------------------------------------------
 
-Scheduler::Scheduler()
+Scheduler::Scheduler(SchedulingPolicyType policyType, ReadyQueueType queueType)
 { 
-    L3Queue = new std::list<Thread *>; 
-    L2Queue = new std::list<Thread *>;
-    L1Queue = new std::list<Thread *>;
+    switch (policyType) {
+      case MLFQScheduling:
+        policy = new MLFQPolicy(queueType);
+        break;
+      case FairScheduling:
+        policy = new FairPolicy();
+        break;
+      case StrideScheduling:
+        policy = new StridePolicy();
+        break;
+      case DeadlineScheduling:
+        policy = new DeadlinePolicy();
+        break;
+      default:
+        ASSERTNOTREACHED();
+    }
     toBeDestroyed = NULL;
-    enablePreemptOnce = false;
 } 
 
 //----------------------------------------------------------------------
@@ -55,9 +60,7 @@ Scheduler::Scheduler()
 
 Scheduler::~Scheduler()
 { 
-    delete L3Queue; 
-    delete L2Queue;
-    delete L1Queue;
+    delete policy;
 } 
 
 //----------------------------------------------------------------------
@@ -75,28 +78,28 @@ Scheduler::ReadyToRun (Thread *thread)
     DEBUG(dbgThread, "Putting thread on ready list: " << thread->getName());
     
     thread->setStatus(READY);
-    thread->setLastInQueueTick(kernel->stats->totalTicks);
     // kernel->currentThread == thread...yielding
-    if (kernel->currentThread != thread) {
-        kernel->currentThread->setT(kernel->currentThread->checkTempTick() / 2 + kernel->currentThread->checkT() / 2);
-        enablePreemptOnce = true;
-    }
-    
-    if (thread->checkPriority() < 50) {
-        // L3
-        printf("Tick %d: Thread %d is inserted into queue L3\n", kernel->stats->totalTicks, thread->getID());
-        L3Queue->push_back(thread);
-    } else if (thread->checkPriority() < 100) {
-        // L2
-        printf("Tick %d: Thread %d is inserted into queue L2\n", kernel->stats->totalTicks, thread->getID());
-        L2Queue->push_back(thread);
-        L2Queue->sort(cmpL2);
-    } else {
-        // L1
-        printf("Tick %d: Thread %d is inserted into queue L1\n", kernel->stats->totalTicks, thread->getID());
-        L1Queue->push_back(thread);
-        L1Queue->sort(cmpL1);
-    }
+    if (kernel->currentThread != thread)
+        policy->Wakeup(thread);
+    policy->Enqueue(thread);
+    kernel->alarm->Rearm();		// it may be worth slicing now
+}
+
+//----------------------------------------------------------------------
+// Scheduler::SetPriority
+// 	Change a thread's priority (for priority inheritance; see
+//	synch.cc).  A ready thread is moved to its new place by the
+//	policy; any other thread just has it set.
+//----------------------------------------------------------------------
+
+void
+Scheduler::SetPriority(Thread *thread, int priority)
+{
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+    if (thread->getStatus() == READY)
+        policy->SetPriority(thread, priority);
+    else
+        thread->setPriority(priority);
 }
 
 //----------------------------------------------------------------------
@@ -111,59 +114,64 @@ Thread *
 Scheduler::FindNextToRun ()
 {
     ASSERT(kernel->interrupt->getLevel() == IntOff);
-    Thread *thread;
-
-    if (L1Queue->empty() && L2Queue->empty() && L3Queue->empty()) {
-        return NULL;
-    } else if (L1Queue->empty() && L2Queue->empty()) {
-        // L3
-        kernel->alarm->setStat(true); // turn on alarm
-        thread = L3Queue->front();
-        L3Queue->pop_front();
-        printf("Tick %d: Thread %d is removed from queue L3\n", kernel->stats->totalTicks, thread->getID());
-        return thread;
-    } else if (L1Queue->empty()) {
-        // L2
-        kernel->alarm->setStat(false); // turn off alarm
-        thread = L2Queue->front();
-        L2Queue->pop_front();
-        printf("Tick %d: Thread %d is removed from queue L2\n", kernel->stats->totalTicks, thread->getID());
-        return thread;
-    } else {
-        // L1
-        kernel->alarm->setStat(false); // turn off alarm
-        thread = L1Queue->front();
-        L1Queue->pop_front();
-        printf("Tick %d: Thread %d is removed from queue L1\n", kernel->stats->totalTicks, thread->getID());
-        return thread;
-    }
-    
-    /*if (L3Queue->IsEmpty()) {
-		return NULL;
-    } else {
-    	return L3Queue->RemoveFront();
-    }*/
+    return policy->PickNext();
 }
 
 Thread* Scheduler::PureFindNext() {
     ASSERT(kernel->interrupt->getLevel() == IntOff);
-    Thread *thread;
+    return policy->Peek();
+}
 
-    if (L1Queue->empty() && L2Queue->empty() && L3Queue->empty()) {
-        return NULL;
-    } else if (L1Queue->empty() && L2Queue->empty()) {
-        // L3
-        thread = L3Queue->front();
-        return thread;
-    } else if (L1Queue->empty()) {
-        // L2
-        thread = L2Queue->front();
-        return thread;
-    } else {
-        // L1
-        thread = L1Queue->front();
-        return thread;
-    }
+//----------------------------------------------------------------------
+// Scheduler::Tick, Scheduler::ShouldPreempt
+// 	Called by Interrupt::OneTick on every tick: let the policy do
+//	its bookkeeping (MLFQ ages the threads that are due), then ask
+//	whether the running thread should yield.
+//
+// Scheduler::SliceOver
+// 	Called by the alarm at every timer interrupt: has the running
+//	thread used up its time slice?
+//
+// Scheduler::WantsTimer
+// 	Could the running thread's time slice be over at the next timer
+//	interrupt?  If not, the alarm turns the timer off (see
+//	Alarm::Rearm).
+//
+// Scheduler::NextEventTick
+// 	Return the first tick at which Tick or ShouldPreempt might have
+//	something to do (now, if there is a preemption check waiting),
+//	or -1 if nothing will until another thread becomes ready.  Used
+//	by Interrupt::QuietTicks.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Tick()
+{
+    policy->Tick();
+}
+
+bool
+Scheduler::ShouldPreempt()
+{
+    return policy->ShouldPreempt();
+}
+
+bool
+Scheduler::SliceOver()
+{
+    return policy->SliceOver();
+}
+
+bool
+Scheduler::WantsTimer()
+{
+    return policy->WantsTimer();
+}
+
+int
+Scheduler::NextEventTick()
+{
+    return policy->NextEventTick();
 }
 
 //----------------------------------------------------------------------
@@ -205,10 +213,17 @@ Scheduler::Run (Thread *nextThread, bool finishing)
 
     kernel->currentThread = nextThread;  // switch to the next thread
     nextThread->setStatus(RUNNING);      // nextThread is now running
+    kernel->alarm->Rearm();		    // it may be time-sliced
     
     DEBUG(dbgThread, "Switching from: " << oldThread->getName() << " to: " << nextThread->getName());
-    printf("Tick %d: Thread %d is now selected for execution\n", kernel->stats->totalTicks, nextThread->getID());
-    printf("Tick %d: Thread %d is replaced, and it has executed %d ticks\n", kernel->stats->totalTicks, oldThread->getID(), oldThread->checkTempTick());
+    kernel->schedTrace->Record(kernel->stats->totalTicks, TraceSelect,
+                               nextThread->getID(), 0, 0, 0);
+    kernel->schedTrace->Record(kernel->stats->totalTicks, TraceReplace,
+                               oldThread->getID(), 0, oldThread->checkTempTick(), 0);
+    oldThread->statistics->Switched(oldThread->checkTempTick(),
+                                    oldThread->getStatus() != READY);
+    nextThread->statistics->Dispatched(kernel->stats->totalTicks,
+                                       nextThread->checkT());
     oldThread->setTempTick(0);
     
     // This is a machine-dependent assembly language routine defined 
@@ -254,12 +269,11 @@ Scheduler::CheckToBeDestroyed()
  
 //----------------------------------------------------------------------
 // Scheduler::Print
-// 	Print the scheduler state -- in other words, the contents of
-//	the ready list.  For debugging.
+// 	Print the scheduler state -- in other words, every process, and
+//	whether it is ready, from the process table.  For debugging.
 //----------------------------------------------------------------------
 void
 Scheduler::Print()
 {
-    cout << "Ready list contents:\n";
-    //L3Queue->Apply(ThreadPrint);
+    kernel->processTable->Print();
 }
@@ -11,41 +11,47 @@
 
 #include "copyright.h"
 #include "thread.h"
-#include <list>
+#include "schedpolicy.h"
 
 // The following class defines the scheduler/dispatcher abstraction -- 
 // the data structures and operations needed to keep track of which 
 // thread is running, and which threads are ready but not running.
+// Which ready thread runs next, and when, is up to the scheduling
+// policy (see schedpolicy.h).
 
 class Scheduler {
   public:
-    bool enablePreemptOnce;
-    Scheduler();		// Initialize list of ready threads 
+    Scheduler(SchedulingPolicyType policyType, ReadyQueueType queueType);
+				// Initialize list of ready threads 
     ~Scheduler();		// De-allocate ready list
 
     void ReadyToRun(Thread* thread);	
     				// Thread can be dispatched.
+    void SetPriority(Thread *thread, int priority);
+				// Change a thread's priority, moving it
+				// in the ready queue if it is there
     Thread* FindNextToRun();	// Dequeue first thread on the ready 
     
     Thread* PureFindNext();
 				// list, if any, and return thread.
+    void Tick();		// Called on every tick (MLFQ ages
+				// threads here)
+    bool ShouldPreempt();	// Should the running thread yield now?
+    bool SliceOver();		// Has it used up its time slice?
+    bool WantsTimer();		// Might it, at the next timer interrupt?
+    int NextEventTick();	// When Tick or ShouldPreempt next
+				// might have something to do
     void Run(Thread* nextThread, bool finishing);
     				// Cause nextThread to start running
     void CheckToBeDestroyed();// Check if thread that had been
     				// running needs to be deleted
     void Print();		// Print contents of ready list
     
-    std::list<Thread *> *getL1Queue() { return L1Queue; }
-    std::list<Thread *> *getL2Queue() { return L2Queue; }
-    std::list<Thread *> *getL3Queue() { return L3Queue; }
-    
     // SelfTest for scheduler is implemented in class Thread
     
   private:
-    std::list<Thread *> *L3Queue;  // queue of threads that are ready to run,
-    std::list<Thread *> *L2Queue;
-    std::list<Thread *> *L1Queue;
-				// but not running
+    SchedulingPolicy *policy;	// keeps the threads that are ready to
+				// run, but not running
     Thread *toBeDestroyed;	// finishing thread to be destroyed
     				// by the next thread that runs
 };
@@ -0,0 +1,149 @@
+// stackpool.cc
+//	Routines to hand out thread execution stacks, reusing the stacks
+//	of deleted threads.  See stackpool.h.
+//
+// 	These routines assume that interrupts are already disabled, or
+//	that they are called before any other thread runs.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "stackpool.h"
+#include "thread.h"
+#include "sysdep.h"
+
+//----------------------------------------------------------------------
+// StackPool::StackPool
+// 	Initialize an empty pool.
+//
+//	"maxFree" -- how many stacks of each size to keep for reuse
+//----------------------------------------------------------------------
+
+StackPool::StackPool(int maxFree)
+{
+    for (int i = 0; i < NumStackSizes; i++) {
+	sizes[i] = 0;
+	freeStacks[i] = NULL;
+	numFree[i] = 0;
+    }
+    this->maxFree = maxFree;
+    numAllocated = numReused = 0;
+}
+
+//----------------------------------------------------------------------
+// StackPool::~StackPool
+// 	Give the stacks that are kept back to the host.  Stacks still in
+//	use are the threads'.
+//----------------------------------------------------------------------
+
+StackPool::~StackPool()
+{
+    for (int i = 0; i < NumStackSizes; i++) {
+	while (freeStacks[i] != NULL) {
+	    int *stack = freeStacks[i];
+
+	    freeStacks[i] = *(int **) stack;
+	    DeallocBoundedArray((char *) stack, sizes[i] * sizeof(int));
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// StackPool::Get
+// 	Return a stack of "size" words: one that is kept, if there is
+//	one of that size, otherwise a new one from the host.  Its
+//	contents are whatever the last thread to use it left there.
+//----------------------------------------------------------------------
+
+int *
+StackPool::Get(int size)
+{
+    ASSERT(size > 0);
+    for (int i = 0; i < NumStackSizes; i++) {
+	if (sizes[i] == size && freeStacks[i] != NULL) {
+	    int *stack = freeStacks[i];
+
+	    freeStacks[i] = *(int **) stack;
+	    numFree[i]--;
+	    numReused++;
+	    return stack;
+	}
+    }
+    numAllocated++;
+    return (int *) AllocBoundedArray(size * sizeof(int));
+}
+
+//----------------------------------------------------------------------
+// StackPool::Put
+// 	Keep a stack that is no longer in use, to hand out again -- or if
+//	there are already as many kept of its size as we keep, or too
+//	many other sizes are kept, give it back to the host.
+//
+//	"stack" -- a stack from Get
+//	"size" -- the size it was got with (in words)
+//----------------------------------------------------------------------
+
+void
+StackPool::Put(int *stack, int size)
+{
+    int i, unused = -1;
+
+    for (i = 0; i < NumStackSizes; i++) {
+	if (sizes[i] == size)
+	    break;
+	if (unused < 0 && sizes[i] == 0)
+	    unused = i;
+    }
+    if (i == NumStackSizes && unused >= 0) {
+	i = unused;			// keep this size from now on
+	sizes[i] = size;
+    }
+    if (i == NumStackSizes || numFree[i] >= maxFree) {
+	DeallocBoundedArray((char *) stack, size * sizeof(int));
+	return;
+    }
+    *(int **) stack = freeStacks[i];
+    freeStacks[i] = stack;
+    numFree[i]++;
+}
+
+//----------------------------------------------------------------------
+// StackPool::SelfTest
+// 	Test whether this module is working, on an empty pool that keeps
+//	2 stacks of a size: check that stacks come back newest first,
+//	that a third is given back to the host, that sizes are kept
+//	apart, and that every page of a stack can be used.
+//----------------------------------------------------------------------
+
+void
+StackPool::SelfTest()
+{
+    int *stacks[3], *small;
+    int i;
+
+    ASSERT(maxFree == 2 && numAllocated == 0);
+    for (i = 0; i < 3; i++) {
+	stacks[i] = Get(StackSize);
+	stacks[i][0] = stacks[i][StackSize - 1] = i;	// both ends
+    }
+    small = Get(StackSize / 4);
+    ASSERT(NumAllocated() == 4 && NumReused() == 0);
+
+    for (i = 0; i < 3; i++)
+	Put(stacks[i], StackSize);	// the last goes back to the host
+    Put(small, StackSize / 4);
+    ASSERT(Get(StackSize / 4) == small);
+    ASSERT(Get(StackSize) == stacks[1]);
+    ASSERT(Get(StackSize) == stacks[0]);
+    ASSERT(stacks[0][StackSize - 1] == 0);	// left as it was
+    ASSERT(NumAllocated() == 4 && NumReused() == 3);
+
+    for (i = 0; i < StackSize; i++)
+	stacks[0][i] = i;
+    Put(stacks[0], StackSize);
+    Put(stacks[1], StackSize);
+    Put(small, StackSize / 4);
+}
@@ -0,0 +1,61 @@
+// stackpool.h
+//	Data structures for a pool of thread execution stacks.
+//
+//	Each stack comes from AllocBoundedArray: mapped from the host
+//	with an unmapped guard page at each end, its pages only taking
+//	up memory once they are touched.  Setting that up, and tearing
+//	it down, takes system calls, so when a thread is deleted its
+//	stack is kept, guard pages and all, and handed to the next
+//	thread that wants a stack of the same size.
+//
+//	Stacks are kept by size, for a few different sizes (most threads
+//	use the default, StackSize); a stack of any other size, or one
+//	beyond the most kept of a size, goes straight back to the host.
+//	A kept stack is linked to the next through its first word, which
+//	the thread using it overwrites anyway.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef STACKPOOL_H
+#define STACKPOOL_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// How many different sizes of stack are kept, and how many of each
+// size at most.
+
+const int NumStackSizes = 4;
+const int MaxFreeStacks = 256;
+
+class StackPool {
+  public:
+    StackPool(int maxFree);	// "maxFree" -- most stacks to keep of
+				// each size
+    ~StackPool();		// give every kept stack back to the host
+
+    int *Get(int size);		// a stack of "size" words
+    void Put(int *stack, int size);
+				// a stack from Get is no longer in use
+
+    int NumAllocated() { return numAllocated; }
+				// stacks that came from the host
+    int NumReused() { return numReused; }
+				// and how many times one was reused
+
+    void SelfTest();		// test whether this module is working
+
+  private:
+    int sizes[NumStackSizes];	// the size of the stacks on each list,
+				// or 0 if no size has the list yet
+    int *freeStacks[NumStackSizes];
+				// stacks not in use, of each size
+    int numFree[NumStackSizes];	// how many are on each list
+    int maxFree;		// keep no more than this many of a size
+    int numAllocated;
+    int numReused;
+};
+
+#endif // STACKPOOL_H
@@ -24,6 +24,8 @@
 // Locks are implemented using a semaphore to keep track of
 // whether the lock is held or not -- a semaphore value of 0 means
 // the lock is busy; a semaphore value of 1 means the lock is free.
+// A thread waiting for a lock lends the holder its priority, if that
+// is higher (see Lock::Acquire).
 //
 // The implementation of condition variables using semaphores is
 // a bit trickier, as explained below under Condition::Wait.
@@ -36,6 +38,20 @@
 #include "synch.h"
 #include "main.h"
 
+//----------------------------------------------------------------------
+// WaiterCompare
+// 	Order the threads waiting on a semaphore, highest priority
+//	first.  A thread goes after those it ties with.
+//----------------------------------------------------------------------
+
+static int
+WaiterCompare(Thread *th1, Thread *th2)
+{
+    if (th1->checkPriority() != th2->checkPriority())
+	return (th1->checkPriority() > th2->checkPriority()) ? -1 : 1;
+    return 0;
+}
+
 //----------------------------------------------------------------------
 // Semaphore::Semaphore
 // 	Initialize a semaphore, so that it can be used for synchronization.
@@ -48,7 +64,7 @@ Semaphore::Semaphore(char* debugName, int initialValue)
 {
     name = debugName;
     value = initialValue;
-    queue = new List<Thread *>;
+    queue = new SortedList<Thread *>(WaiterCompare);
 }
 
 //----------------------------------------------------------------------
@@ -68,6 +84,10 @@ Semaphore::~Semaphore()
 //	value and decrementing must be done atomically, so we
 //	need to disable interrupts before checking the value.
 //
+//	A thread that has to wait is handed its unit of the value
+//	directly by V, so that a thread that comes along before it runs
+//	can't take it first -- not even one of lower priority.
+//
 //	Note that Thread::Sleep assumes that interrupts are disabled
 //	when it is called.
 //----------------------------------------------------------------------
@@ -81,11 +101,13 @@ Semaphore::P()
     // disable interrupts
     IntStatus oldLevel = interrupt->SetLevel(IntOff);	
     
-    while (value == 0) { 		// semaphore not available
-	queue->Append(currentThread);	// so go to sleep
+    if (value > 0) {
+	value--; 		// semaphore available, consume its value
+    } else { 			// semaphore not available
+	queue->Insert(currentThread);	// so go to sleep, until V
+	currentThread->setWaitingOn(this);	// hands us the value
 	currentThread->Sleep(FALSE);
     } 
-    value--; 			// semaphore available, consume its value
    
     // re-enable interrupts
     (void) interrupt->SetLevel(oldLevel);	
@@ -93,7 +115,8 @@ Semaphore::P()
 
 //----------------------------------------------------------------------
 // Semaphore::V
-// 	Increment semaphore value, waking up a waiter if necessary.
+// 	Increment semaphore value, or if there is a waiter, wake up the
+//	first one and hand the increment straight to it.
 //	As with P(), this operation must be atomic, so we need to disable
 //	interrupts.  Scheduler::ReadyToRun() assumes that interrupts
 //	are disabled when it is called.
@@ -108,14 +131,42 @@ Semaphore::V()
     IntStatus oldLevel = interrupt->SetLevel(IntOff);	
     
     if (!queue->IsEmpty()) {  // make thread ready.
-	kernel->scheduler->ReadyToRun(queue->RemoveFront());
+	Thread *thread = queue->RemoveFront();
+
+	thread->setWaitingOn(NULL);
+	kernel->scheduler->ReadyToRun(thread);
+    } else {
+	value++;
     }
-    value++;
     
     // re-enable interrupts
     (void) interrupt->SetLevel(oldLevel);
 }
 
+//----------------------------------------------------------------------
+// Semaphore::FirstWaiter
+// 	Return the thread V would wake, or NULL if none is waiting.
+//
+// Semaphore::Requeue
+// 	The priority of a waiting thread has changed (it has inherited
+//	one; see Lock::Donate): move it to its place for the new one.
+//
+//	Both assume that interrupts are disabled.
+//----------------------------------------------------------------------
+
+Thread *
+Semaphore::FirstWaiter()
+{
+    return queue->IsEmpty() ? NULL : queue->Front();
+}
+
+void
+Semaphore::Requeue(Thread *thread)
+{
+    queue->Remove(thread);
+    queue->Insert(thread);
+}
+
 //----------------------------------------------------------------------
 // Semaphore::SelfTest, SelfTestHelper
 // 	Test the semaphore implementation, by using a semaphore
@@ -160,6 +211,11 @@ Lock::Lock(char* debugName)
     name = debugName;
     semaphore = new Semaphore("lock", 1);  // initially, unlocked
     lockHolder = NULL;
+    nextHeld = NULL;
+    profile = NULL;
+    if (kernel->lockProfile != NULL)
+	profile = kernel->lockProfile->Find(name, FALSE);
+    acquireTick = 0;
 }
 
 //----------------------------------------------------------------------
@@ -176,12 +232,38 @@ Lock::~Lock()
 //	Atomically wait until the lock is free, then set it to busy.
 //	Equivalent to Semaphore::P(), with the semaphore value of 0
 //	equal to busy, and semaphore value of 1 equal to free.
+//
+//	If we have to wait, first lend the holder our priority (see
+//	Lock::Donate).  The threads waiting are woken highest priority
+//	first, so whichever is handed the lock next already has the
+//	highest priority of those still waiting -- it never needs to
+//	be raised for them.
+//
+//	If profiling, count the acquisition, and how long we waited.
 //----------------------------------------------------------------------
 
 void Lock::Acquire()
 {
+    Thread *currentThread = kernel->currentThread;
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    bool contended = (lockHolder != NULL);
+    int start = kernel->stats->totalTicks;
+
+    if (contended && kernel->priorityInheritance) {
+	currentThread->setWaitingFor(this);
+	Donate(currentThread->checkPriority());
+    }
     semaphore->P();
-    lockHolder = kernel->currentThread;
+    currentThread->setWaitingFor(NULL);
+    lockHolder = currentThread;
+    nextHeld = currentThread->checkHeldLocks();
+    currentThread->setHeldLocks(this);
+    if (profile != NULL) {
+	acquireTick = kernel->stats->totalTicks;
+	profile->Acquired(contended, acquireTick - start);
+    }
+
+    (void) kernel->interrupt->SetLevel(oldLevel);
 }
 
 //----------------------------------------------------------------------
@@ -193,13 +275,117 @@ void Lock::Acquire()
 //
 //	By convention, only the thread that acquired the lock
 // 	may release it.
+//
+//	The semaphore hands the lock straight to the first thread
+//	waiting, if there is one, so it is the holder from now on: a
+//	thread that then has to wait lends its priority to that one.
+//	We give up whatever priority the threads still waiting for this
+//	lock had lent us.
+//
+//	If profiling, count how long the lock was held.
 //---------------------------------------------------------------------
 
 void Lock::Release()
 {
+    Thread *currentThread = kernel->currentThread;
+    IntStatus oldLevel;
+
     ASSERT(IsHeldByCurrentThread());
-    lockHolder = NULL;
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    if (profile != NULL)
+	profile->Released(kernel->stats->totalTicks - acquireTick);
+    Unlink();
+    lockHolder = semaphore->FirstWaiter();	// NULL if there is none
+    if (currentThread->checkBasePriority() >= 0)
+	Restore(currentThread);
     semaphore->V();
+
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Lock::Donate
+//	A thread of "priority" is waiting for this lock: raise the holder
+//	to that priority, if it is lower, keeping the holder's own
+//	priority to go back to.  If the holder is waiting for a lock
+//	itself, raise that lock's holder too, and so on, until we come to
+//	a holder that isn't waiting for a lock or already has the
+//	priority.  (So a deadlocked cycle of holders ends the chain too.)
+//
+//	No thread but main may reach MainPriority (see schedparams.h), so
+//	main waiting only lends the highest priority a thread may have.
+//	Interrupts are disabled.
+//----------------------------------------------------------------------
+
+void
+Lock::Donate(int priority)
+{
+    Lock *lock = this;
+
+    priority = min(priority, kernel->schedParams->maxPriority);
+    while (lock != NULL && lock->lockHolder != NULL
+	   && lock->lockHolder->checkPriority() < priority) {
+	Thread *holder = lock->lockHolder;
+
+	DEBUG(dbgThread, "Raising " << holder->getName() << " from priority "
+	      << holder->checkPriority() << " to " << priority
+	      << ", for lock " << lock->name);
+	if (holder->checkBasePriority() < 0)
+	    holder->setBasePriority(holder->checkPriority());
+	kernel->scheduler->SetPriority(holder, priority);
+	if (holder->checkWaitingOn() != NULL)	// blocked: move it up
+	    holder->checkWaitingOn()->Requeue(holder);	// in its wait
+	lock = holder->checkWaitingFor();
+    }
+}
+
+//----------------------------------------------------------------------
+// Lock::Unlink
+//	Take this lock off the list of locks its holder holds.  Locks
+//	tend to be released in the reverse order they were acquired, so
+//	it is usually at the front.
+//----------------------------------------------------------------------
+
+void
+Lock::Unlink()
+{
+    Lock *lock = lockHolder->checkHeldLocks();
+
+    if (lock == this) {
+	lockHolder->setHeldLocks(nextHeld);
+    } else {
+	while (lock->nextHeld != this)
+	    lock = lock->nextHeld;
+	lock->nextHeld = nextHeld;
+    }
+    nextHeld = NULL;
+}
+
+//----------------------------------------------------------------------
+// Lock::Restore
+//	A thread that had inherited priority has released a lock: set its
+//	priority back to its own, or to the highest priority of the
+//	threads still waiting for the locks it holds, if that is higher.
+//	Interrupts are disabled.
+//----------------------------------------------------------------------
+
+void
+Lock::Restore(Thread *thread)
+{
+    int priority = thread->checkBasePriority();
+
+    for (Lock *lock = thread->checkHeldLocks(); lock != NULL;
+	 lock = lock->nextHeld) {
+	Thread *waiter = lock->semaphore->FirstWaiter();
+
+	if (waiter != NULL)
+	    priority = max(priority, min(waiter->checkPriority(),
+					 kernel->schedParams->maxPriority));
+    }
+    if (priority == thread->checkBasePriority())
+	thread->setBasePriority(-1);	// nothing inherited any more
+    kernel->scheduler->SetPriority(thread, priority);
 }
 
 //----------------------------------------------------------------------
@@ -214,6 +400,9 @@ Condition::Condition(char* debugName)
 {
     name = debugName;
     waitQueue = new List<Semaphore *>;
+    profile = NULL;
+    if (kernel->lockProfile != NULL)
+	profile = kernel->lockProfile->Find(name, TRUE);
 }
 
 //----------------------------------------------------------------------
@@ -238,12 +427,16 @@ Condition::~Condition()
 //	Note: we assume Mesa-style semantics, which means that the
 //	waiter must re-acquire the monitor lock when waking up.
 //
+//	If profiling, count the wait, and how long it was until we were
+//	signalled (re-acquiring the lock counts against the lock).
+//
 //	"conditionLock" -- lock protecting the use of this condition
 //----------------------------------------------------------------------
 
 void Condition::Wait(Lock* conditionLock) 
 {
      Semaphore *waiter;
+     int start = kernel->stats->totalTicks;
     
      ASSERT(conditionLock->IsHeldByCurrentThread());
 
@@ -251,6 +444,8 @@ void Condition::Wait(Lock* conditionLock)
      waitQueue->Append(waiter);
      conditionLock->Release();
      waiter->P();
+     if (profile != NULL)
+	profile->Waited(kernel->stats->totalTicks - start);
      conditionLock->Acquire();
      delete waiter;
 }
@@ -276,6 +471,8 @@ void Condition::Signal(Lock* conditionLock)
     
     ASSERT(conditionLock->IsHeldByCurrentThread());
     
+    if (profile != NULL)
+	profile->Signalled(!waitQueue->IsEmpty());
     if (!waitQueue->IsEmpty()) {
         waiter = waitQueue->RemoveFront();
 	waiter->V();
@@ -21,6 +21,7 @@
 #include "thread.h"
 #include "list.h"
 #include "main.h"
+#include "lockprofile.h"
 
 // The following class defines a "semaphore" whose value is a non-negative
 // integer.  The semaphore has only two operations P() and V():
@@ -36,6 +37,9 @@
 // into a register, a context switch might have occurred,
 // and some other thread might have called P or V, so the true value might
 // now be different.
+//
+// Threads waiting in P() are woken highest priority first, and in the
+// order they came among equals.
 
 class Semaphore {
   public:
@@ -46,12 +50,18 @@ class Semaphore {
     void P();	 	// these are the only operations on a semaphore
     void V();	 	// they are both *atomic*
     void SelfTest();	// test routine for semaphore implementation
+
+    Thread *FirstWaiter();	// the thread V() would wake, or NULL
+    void Requeue(Thread *thread);
+    				// a waiting thread's priority has
+				// changed: move it to its new place
     
   private:
     char* name;        // useful for debugging
     int value;         // semaphore value, always >= 0
-    List<Thread *> *queue;     
-		  	// threads waiting in P() for the value to be > 0
+    SortedList<Thread *> *queue;     
+		  	// threads waiting in P() for the value to be > 0,
+			// highest priority first
    };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -65,6 +75,12 @@ class Semaphore {
 // In addition, by convention, only the thread that acquired the lock
 // may release it.  As with semaphores, you can't read the lock value
 // (because the value might change immediately after you read it).  
+//
+// Locks pass on priority: while a thread waits to acquire a lock, the
+// holder runs at the waiter's priority if that is higher, until it
+// releases the lock.  If the holder is itself waiting for a lock, that
+// lock's holder is raised too, and so on down the chain.  (Unless the
+// kernel was started with -npi.)
 
 class Lock {
   public:
@@ -86,6 +102,18 @@ class Lock {
     char *name;			// debugging assist
     Thread *lockHolder;		// thread currently holding lock
     Semaphore *semaphore;	// we use a semaphore to implement lock
+    Lock *nextHeld;		// the next lock the holder holds
+    LockStats *profile;		// contention statistics for our name,
+				// or NULL if not profiling (-lp)
+    int acquireTick;		// when the holder acquired it, if
+				// profiling
+
+    void Donate(int priority);	// raise the holder, and the holders it
+				// waits for, to at least "priority"
+    void Unlink();		// take this lock off its holder's locks
+    static void Restore(Thread *thread);
+				// give up priority inherited through
+				// locks the thread no longer holds
 };
 
 // The following class defines a "condition variable".  A condition
@@ -140,5 +168,7 @@ class Condition {
   private:
     char* name;
     List<Semaphore *> *waitQueue;	// list of waiting threads
+    LockStats *profile;		// contention statistics for our name,
+				// or NULL if not profiling (-lp)
 };
 #endif // SYNCH_H
@@ -17,14 +17,20 @@
 //	Allocate and initialize the data structures needed for a 
 //	synchronized list, empty to start with.
 //	Elements can now be added to the list.
+//
+//	"debugName" is an arbitrary name, useful for debugging, and for
+//	telling the list's lock and condition apart in the lock profile
+//	(see lockprofile.h), which keeps a copy of it.  The lock and
+//	condition keep the pointer itself, so it must last as long as
+//	the list.
 //----------------------------------------------------------------------
 
 template <class T>
-SynchList<T>::SynchList()
+SynchList<T>::SynchList(char *debugName)
 {
     list = new List<T>;
-    lock = new Lock("list lock"); 
-    listEmpty = new Condition("list empty cond");
+    lock = new Lock(debugName); 
+    listEmpty = new Condition(debugName);
 }
 
 //----------------------------------------------------------------------
@@ -120,7 +126,7 @@ SynchList<T>::SelfTest(T val)
     Thread *helper = new Thread("ping", 1);
     
     ASSERT(list->IsEmpty());
-    selfTestPing = new SynchList<T>;
+    selfTestPing = new SynchList<T>((char *) "synch list ping");
     helper->Fork(SynchList<T>::SelfTestHelper, this);
     for (int i = 0; i < 10; i++) {
         selfTestPing->Append(val);
@@ -23,7 +23,8 @@
 template <class T>
 class SynchList {
   public:
-    SynchList();		// initialize a synchronized list
+    SynchList(char *debugName);	// initialize a synchronized list; its
+				// lock and condition are given its name
     ~SynchList();		// de-allocate a synchronized list
 
     void Append(T item);	// append item to the end of the list,
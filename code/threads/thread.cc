@@ -40,6 +40,7 @@ Thread::Thread(char* threadName, int threadID)
     name = threadName;
     stackTop = NULL;
     stack = NULL;
+    stackSize = StackSize;
     status = JUST_CREATED;
     for (int i = 0; i < MachineStateSize; i++) {
 	machineState[i] = NULL;		// not strictly necessary, since
@@ -47,10 +48,20 @@ Thread::Thread(char* threadName, int threadID)
 					// of machine registers
     }
     space = NULL;
+    statistics = kernel->stats->NewThread(threadID, threadName);
     priority = 0;
     tempTick = 0;
     t = 0;
     lastInQueueTick = 0;
+    readySeq = 0;
+    readyIndex = -1;
+    readyPrev = readyNext = NULL;
+    agingIndex = -1;
+    schedKey = 0;
+    basePriority = -1;
+    waitingOn = NULL;
+    waitingFor = NULL;
+    heldLocks = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -70,7 +81,9 @@ Thread::~Thread()
     DEBUG(dbgThread, "Deleting thread: " << name);
     ASSERT(this != kernel->currentThread);
     if (stack != NULL)
-	DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+	kernel->stackPool->Put(stack, stackSize);	// for the next thread
+    if (space != NULL)
+	delete space;		// give its memory back
 }
 
 //----------------------------------------------------------------------
@@ -129,13 +142,29 @@ Thread::CheckOverflow()
 {
     if (stack != NULL) {
 #ifdef HPUX			// Stacks grow upward on the Snakes
-	ASSERT(stack[StackSize - 1] == STACK_FENCEPOST);
+	ASSERT(stack[stackSize - 1] == STACK_FENCEPOST);
 #else
 	ASSERT(*stack == STACK_FENCEPOST);
 #endif
    }
 }
 
+//----------------------------------------------------------------------
+// Thread::setStackSize
+// 	Give the thread a stack of some other size than StackSize.  The
+//	stack is allocated by Fork, so this must come before it.
+//
+//	"inSize" -- the size of the stack, in words
+//----------------------------------------------------------------------
+
+void
+Thread::setStackSize(int inSize)
+{
+    ASSERT(stack == NULL && status == JUST_CREATED);
+    ASSERT(inSize > 0);
+    stackSize = inSize;
+}
+
 //----------------------------------------------------------------------
 // Thread::Begin
 // 	Called by ThreadRoot when a thread is about to begin
@@ -179,6 +208,8 @@ Thread::Finish ()
     ASSERT(this == kernel->currentThread);
     
     DEBUG(dbgThread, "Finishing thread: " << name);
+    statistics->finishTick = kernel->stats->totalTicks;
+    kernel->processTable->Exit(this);	// its PID can be reused
     Sleep(TRUE);				// invokes SWITCH
     // not reached
 }
@@ -310,34 +341,34 @@ PLabelToAddr(void *plabel)
 void
 Thread::StackAllocate (VoidFunctionPtr func, void *arg)
 {
-    stack = (int *) AllocBoundedArray(StackSize * sizeof(int));
+    stack = kernel->stackPool->Get(stackSize);
 
 #ifdef PARISC
     // HP stack works from low addresses to high addresses
     // everyone else works the other way: from high addresses to low addresses
     stackTop = stack + 16;	// HP requires 64-byte frame marker
-    stack[StackSize - 1] = STACK_FENCEPOST;
+    stack[stackSize - 1] = STACK_FENCEPOST;
 #endif
 
 #ifdef SPARC
-    stackTop = stack + StackSize - 96; 	// SPARC stack must contains at 
+    stackTop = stack + stackSize - 96; 	// SPARC stack must contains at 
 					// least 1 activation record 
 					// to start with.
     *stack = STACK_FENCEPOST;
 #endif 
 
 #ifdef PowerPC // RS6000
-    stackTop = stack + StackSize - 16; 	// RS6000 requires 64-byte frame marker
+    stackTop = stack + stackSize - 16; 	// RS6000 requires 64-byte frame marker
     *stack = STACK_FENCEPOST;
 #endif 
 
 #ifdef DECMIPS
-    stackTop = stack + StackSize - 4;	// -4 to be on the safe side!
+    stackTop = stack + stackSize - 4;	// -4 to be on the safe side!
     *stack = STACK_FENCEPOST;
 #endif
 
 #ifdef ALPHA
-    stackTop = stack + StackSize - 8;	// -8 to be on the safe side!
+    stackTop = stack + stackSize - 8;	// -8 to be on the safe side!
     *stack = STACK_FENCEPOST;
 #endif
 
@@ -346,7 +377,7 @@ Thread::StackAllocate (VoidFunctionPtr func, void *arg)
     // the x86 passes the return address on the stack.  In order for SWITCH() 
     // to go to ThreadRoot when we switch to this thread, the return addres 
     // used in SWITCH() must be the starting address of ThreadRoot.
-    stackTop = stack + StackSize - 4;	// -4 to be on the safe side!
+    stackTop = stack + stackSize - 4;	// -4 to be on the safe side!
     *(--stackTop) = (int) ThreadRoot;
     *stack = STACK_FENCEPOST;
 #endif
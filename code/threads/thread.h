@@ -42,6 +42,10 @@
 #include "sysdep.h"
 #include "machine.h"
 #include "addrspace.h"
+#include "stats.h"
+
+class Semaphore;
+class Lock;
 
 // CPU register state to be saved on context switch.  
 // The x86 needs to save only a few registers, 
@@ -53,7 +57,8 @@
 #define MachineStateSize 75 
 
 
-// Size of the thread's private execution stack.
+// Size of the thread's private execution stack, unless it is set
+// otherwise (with setStackSize) before the thread is forked.
 // WATCH OUT IF THIS ISN'T BIG ENOUGH!!!!!
 const int StackSize = (8 * 1024);	// in words
 
@@ -97,6 +102,24 @@ class Thread {
     int checkT() { return t; }
     void setLastInQueueTick(int inTick) { lastInQueueTick = inTick; }
     int checkLastInQueueTick() { return lastInQueueTick; }
+    void setReadySeq(int inSeq) { readySeq = inSeq; }
+    int checkReadySeq() { return readySeq; }
+    void setReadyIndex(int inIndex) { readyIndex = inIndex; }
+    int checkReadyIndex() { return readyIndex; }
+    void setAgingIndex(int inIndex) { agingIndex = inIndex; }
+    int checkAgingIndex() { return agingIndex; }
+    void setSchedKey(long long inKey) { schedKey = inKey; }
+    long long checkSchedKey() { return schedKey; }
+    void setStackSize(int inSize);	// in words; only before Fork
+    int checkStackSize() { return stackSize; }
+    void setBasePriority(int inPriority) { basePriority = inPriority; }
+    int checkBasePriority() { return basePriority; }
+    void setWaitingOn(Semaphore *inSemaphore) { waitingOn = inSemaphore; }
+    Semaphore *checkWaitingOn() { return waitingOn; }
+    void setWaitingFor(Lock *inLock) { waitingFor = inLock; }
+    Lock *checkWaitingFor() { return waitingFor; }
+    void setHeldLocks(Lock *inLocks) { heldLocks = inLocks; }
+    Lock *checkHeldLocks() { return heldLocks; }
 
     void Fork(VoidFunctionPtr func, void *arg); 
     				// Make thread run (*func)(arg)
@@ -122,6 +145,7 @@ class Thread {
     int *stack; 	 	// Bottom of the stack 
 				// NULL if this is the main thread
 				// (If NULL, don't deallocate stack)
+    int stackSize;		// how big it is, in words
     ThreadStatus status;	// ready, running or blocked
     char* name;
 	int   ID;
@@ -131,6 +155,24 @@ class Thread {
     int tempTick;
     int t;
     int lastInQueueTick;
+    int readySeq;		// breaks ties in the ready queues: the
+				// order the thread took its place in
+    int readyIndex;		// where the thread is in its ready queue,
+				// -1 if it isn't in one
+    int agingIndex;		// where the thread is in the scheduler's
+				// aging heap, -1 if it isn't
+    long long schedKey;		// what the scheduling policy orders the
+				// thread by, if not MLFQ (see
+				// schedpolicy.h)
+    int basePriority;		// its own priority, while it has a higher
+				// one inherited from a thread waiting on
+				// a lock it holds; -1 if it has none
+    Semaphore *waitingOn;	// the semaphore it is waiting on in P,
+				// or NULL
+    Lock *waitingFor;		// the lock it is waiting to acquire, or
+				// NULL
+    Lock *heldLocks;		// the locks it holds, linked through
+				// Lock::nextHeld (see synch.h)
     
     				// Allocate a stack for thread.
 				// Used internally by Fork()
@@ -146,6 +188,10 @@ class Thread {
     void RestoreUserState();		// restore user-level register state
 
     AddrSpace *space;			// User code this thread is running.
+    ThreadStatistics *statistics;	// Performance metrics of this thread,
+					// kept by kernel->stats
+    Thread *readyPrev, *readyNext;	// neighbours on a ready list, if
+					// the ready queue is kept in lists
 };
 
 // external function, dummy routine whose sole job is to call Thread::Print
@@ -0,0 +1,228 @@
+// timerwheel.cc
+//	Routines to keep sleeping threads on a hierarchical timer wheel,
+//	and take them off when they are due.  See timerwheel.h.
+//
+// 	These routines assume that interrupts are already disabled, or
+//	that they are called before any other thread runs.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "timerwheel.h"
+
+// The farthest ahead, in jiffies, that a sleeper can be placed.
+
+static const int WheelReach = (1 << (WheelSlotBits * NumWheelLevels)) - 1;
+
+//----------------------------------------------------------------------
+// TimerWheel::TimerWheel
+// 	Initialize an empty wheel.
+//
+//	"jiffyTicks" -- how many ticks make a jiffy (the timer's period)
+//	"now" -- the current time, in ticks
+//----------------------------------------------------------------------
+
+TimerWheel::TimerWheel(int jiffyTicks, int now)
+{
+    ASSERT(jiffyTicks > 0);
+    for (int level = 0; level < NumWheelLevels; level++) {
+	for (int i = 0; i < NumWheelSlots; i++) {
+	    TimerEntry *head = &slots[level][i];
+
+	    head->thread = NULL;
+	    head->prev = head->next = head;
+	}
+    }
+    this->jiffyTicks = jiffyTicks;
+    curJiffy = now / jiffyTicks;
+    numEntries = 0;
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::Insert
+// 	Put an entry on the wheel, due in the first jiffy that ends at or
+//	after tick "when" -- or, if that is already past, in the next one.
+//
+//	"entry" -- the caller's entry, with "thread" set
+//	"when" -- the time it is due, in ticks
+//----------------------------------------------------------------------
+
+void
+TimerWheel::Insert(TimerEntry *entry, int when)
+{
+    entry->expires = divRoundUp(when, jiffyTicks);
+    if (entry->expires <= curJiffy)
+	entry->expires = curJiffy + 1;
+    Place(entry);
+    numEntries++;
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::Remove
+// 	Take an entry off the wheel before it is due.
+//----------------------------------------------------------------------
+
+void
+TimerWheel::Remove(TimerEntry *entry)
+{
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    entry->prev = entry->next = NULL;
+    numEntries--;
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::Place
+// 	Link an entry into the slot that its jiffy falls in, at the
+//	level that only just reaches that far ahead of the current
+//	jiffy; or, if it is beyond the top level, into the farthest slot
+//	there, to be placed again when that slot comes round.
+//----------------------------------------------------------------------
+
+void
+TimerWheel::Place(TimerEntry *entry)
+{
+    int jiffy = entry->expires;
+    int level = 0;
+    TimerEntry *head;
+
+    ASSERT(jiffy >= curJiffy);
+    if (jiffy - curJiffy > WheelReach)
+	jiffy = curJiffy + WheelReach;
+    while (level < NumWheelLevels - 1
+	   && jiffy - curJiffy >= (1 << (WheelSlotBits * (level + 1))))
+	level++;
+    head = &slots[level][(jiffy >> (WheelSlotBits * level))
+			 & (NumWheelSlots - 1)];
+
+    entry->prev = head->prev;		// at the end of the list
+    entry->next = head;
+    head->prev->next = entry;
+    head->prev = entry;
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::Cascade
+// 	The current jiffy starts a new slot of "level": empty that slot,
+//	placing each of its entries again, now that they are closer.
+//----------------------------------------------------------------------
+
+void
+TimerWheel::Cascade(int level)
+{
+    TimerEntry *head = &slots[level][(curJiffy >> (WheelSlotBits * level))
+				     & (NumWheelSlots - 1)];
+    TimerEntry *entry = head->next;
+
+    if (entry == head)
+	return;				// nothing in it
+    head->prev->next = NULL;		// detach the list: an entry may
+    head->prev = head->next = head;	// go back in this same slot
+    while (entry != NULL) {
+	TimerEntry *next = entry->next;
+
+	Place(entry);
+	entry = next;
+    }
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::Advance
+// 	Move the wheel on, a jiffy at a time, to the jiffy that "now"
+//	falls in, and take off every entry due by then.  Return them,
+//	earliest first, linked through "next" and ending in NULL.
+//
+//	An empty wheel just jumps to "now", so a wheel that is not
+//	advanced while nothing is sleeping costs nothing to catch up.
+//----------------------------------------------------------------------
+
+TimerEntry *
+TimerWheel::Advance(int now)
+{
+    int target = now / jiffyTicks;
+    TimerEntry *due = NULL, *last = NULL;
+
+    while (curJiffy < target) {
+	if (numEntries == 0) {
+	    curJiffy = target;
+	    break;
+	}
+	curJiffy++;
+	for (int level = NumWheelLevels - 1; level > 0; level--) {
+	    if ((curJiffy & ((1 << (WheelSlotBits * level)) - 1)) == 0)
+		Cascade(level);
+	}
+
+	TimerEntry *head = &slots[0][curJiffy & (NumWheelSlots - 1)];
+	if (head->next != head) {	// move the whole slot onto the list
+	    if (last == NULL)
+		due = head->next;
+	    else
+		last->next = head->next;
+	    last = head->prev;
+	    last->next = NULL;
+	    for (TimerEntry *entry = head->next; entry != NULL;
+		 entry = entry->next) {
+		ASSERT(entry->expires == curJiffy);
+		entry->prev = NULL;
+		numEntries--;
+	    }
+	    head->prev = head->next = head;
+	}
+    }
+    return due;
+}
+
+//----------------------------------------------------------------------
+// TimerWheel::SelfTest
+// 	Test whether this module is working, on an empty wheel of
+//	10-tick jiffies, started at time 0: put on sleepers due at every
+//	level, and beyond the top, with some due at once, take one off
+//	early, and then advance the wheel in uneven steps, checking that
+//	each sleeper comes off exactly in its own jiffy.
+//----------------------------------------------------------------------
+
+void
+TimerWheel::SelfTest()
+{
+    static int whens[] = { 0, 1, 9, 10, 11, 10, 639, 640, 641, 5003,
+			   40961, 409603, 2621441, 3000000, 20000000,
+			   167772165, 170000001 };
+    const int numWhens = sizeof(whens) / sizeof(whens[0]);
+    TimerEntry entries[numWhens];
+    bool woken[numWhens];
+    int i, now, last = 0, numWoken = 0;
+
+    ASSERT(jiffyTicks == 10 && curJiffy == 0 && IsEmpty());
+    for (i = 0; i < numWhens; i++) {
+	entries[i].thread = NULL;
+	Insert(&entries[i], whens[i]);
+	woken[i] = FALSE;
+    }
+    Remove(&entries[7]);		// 640 will never come off
+    woken[7] = TRUE;
+    numWoken++;
+    ASSERT(NumEntries() == numWhens - 1);
+
+    for (now = 0; !IsEmpty(); last = now, now += (now < 10000) ? 7 : 997) {
+	for (TimerEntry *entry = Advance(now); entry != NULL;
+	     entry = entry->next) {
+	    i = entry - entries;
+	    ASSERT(!woken[i]);
+	    woken[i] = TRUE;
+	    numWoken++;
+	    if (whens[i] == 0) {	// due at once: the next jiffy
+		ASSERT(now / 10 == 1);
+	    } else {			// due now, and not a step ago
+		ASSERT(divRoundUp(whens[i], 10) <= now / 10
+		       && divRoundUp(whens[i], 10) > last / 10);
+	    }
+	}
+    }
+    ASSERT(numWoken == numWhens);
+    now += 1000000;			// empty, so it jumps
+    ASSERT(Advance(now) == NULL && curJiffy == now / 10);
+}
@@ -0,0 +1,89 @@
+// timerwheel.h
+//	Data structures for a hierarchical timer wheel: the threads that
+//	are sleeping until some time, so that the alarm clock can wake
+//	each one once its time has come.
+//
+//	Time on the wheel goes in "jiffies" of a fixed number of ticks
+//	(the timer's period), and the alarm clock advances it a jiffy
+//	at a time.  The wheel has NumWheelLevels levels of NumWheelSlots
+//	slots each.  A sleeper due within NumWheelSlots jiffies goes in
+//	the bottom level, in the slot for its jiffy; one due later goes
+//	in a coarser level, whose slots each cover NumWheelSlots times as
+//	many jiffies as the level below.  Each time the bottom level goes
+//	all the way round, the next slot of the level above is emptied
+//	into it (and so on up), so each sleeper only moves a level or
+//	two before it is due.  Putting a sleeper on the wheel, taking it
+//	off, and advancing by a jiffy all take constant time, however
+//	many threads are sleeping.
+//
+//	A sleeper's entry is the caller's, linked into a slot's list; a
+//	sleeping thread keeps its entry on its own stack.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include "copyright.h"
+#include "utility.h"
+
+class Thread;
+
+// The shape of the wheel: 4 levels of 64 slots reach 2^24 jiffies
+// ahead; a sleeper due any later waits in the farthest slot, and is
+// put back when that slot comes round.
+
+const int WheelSlotBits = 6;
+const int NumWheelSlots = 1 << WheelSlotBits;
+const int NumWheelLevels = 4;
+
+// A sleeper on the wheel.  The slots' lists are circular, each with
+// an entry of its own as the head, so an entry can be taken out
+// without knowing which slot it is in.
+
+class TimerEntry {
+  public:
+    Thread *thread;		// the thread to wake
+    int expires;		// the jiffy it is due in
+    TimerEntry *prev;		// the entries before and after it
+    TimerEntry *next;		// in its slot
+};
+
+class TimerWheel {
+  public:
+    TimerWheel(int jiffyTicks, int now);
+				// "jiffyTicks" -- ticks in each jiffy;
+				// "now" -- the time to start at
+    ~TimerWheel() {}		// the entries are the callers'
+
+    void Insert(TimerEntry *entry, int when);
+				// put an entry on the wheel, due at tick
+				// "when"
+    void Remove(TimerEntry *entry);
+				// take an entry off the wheel, before
+				// it is due
+    TimerEntry *Advance(int now);
+				// take off every entry that is due by
+				// "now", and return them, linked through
+				// "next"
+    bool IsEmpty() { return numEntries == 0; }
+    int NumEntries() { return numEntries; }
+
+    void SelfTest();		// test whether this module is working
+
+  private:
+    void Place(TimerEntry *entry);
+				// link an entry into the slot for its jiffy
+    void Cascade(int level);	// empty the current slot of a level into
+				// the levels below
+
+    TimerEntry slots[NumWheelLevels][NumWheelSlots];
+				// the head of each slot's list
+    int jiffyTicks;		// ticks in a jiffy
+    int curJiffy;		// the last jiffy the wheel advanced to
+    int numEntries;		// entries on the wheel
+};
+
+#endif // TIMERWHEEL_H
@@ -0,0 +1,214 @@
+// workload.cc
+//	Routines to read a workload, and start its programs as they
+//	arrive.  See workload.h for the workload file.
+//
+//	Arrival ticks count from when the workload is started (just
+//	after any self tests).  Jobs arriving at the same tick start in
+//	the order they were added, so "-ep a 1 -ep b 2" still gives a
+//	thread 1 and b thread 2.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "workload.h"
+#include "main.h"
+#include <stdio.h>
+#include <string.h>
+
+//----------------------------------------------------------------------
+// JobCompare
+// 	Order the pending jobs by when their next copy arrives, and
+//	jobs that arrive together by the order they were added.
+//----------------------------------------------------------------------
+
+static int
+JobCompare(Job *job1, Job *job2)
+{
+    if (job1->arrival != job2->arrival)
+	return (job1->arrival < job2->arrival) ? -1 : 1;
+    if (job1->seq != job2->seq)
+	return (job1->seq < job2->seq) ? -1 : 1;
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// Workload::Workload
+// 	Initialize an empty workload.
+//
+// Workload::~Workload
+// 	De-allocate it, and every job added to it.
+//----------------------------------------------------------------------
+
+Workload::Workload()
+{
+    pending = new Heap<Job *>(JobCompare);
+    jobs = new List<Job *>;
+    numStarted = numExited = 0;
+    startTick = 0;
+}
+
+Workload::~Workload()
+{
+    while (!jobs->IsEmpty()) {
+	Job *job = jobs->RemoveFront();
+
+	delete [] job->program;
+	delete job;
+    }
+    delete jobs;
+    delete pending;
+}
+
+//----------------------------------------------------------------------
+// Workload::Add
+// 	Add a job: "count" copies of a program, the first arriving
+//	"arrival" ticks after the workload starts, and then one every
+//	"interval" ticks.
+//----------------------------------------------------------------------
+
+void
+Workload::Add(char *program, int priority, int arrival, int count,
+	      int interval)
+{
+    Job *job = new Job;
+
+    ASSERT(arrival >= 0 && count >= 0 && interval >= 0);
+    job->program = new char[strlen(program) + 1];
+    strcpy(job->program, program);
+    job->priority = priority;
+    job->arrival = arrival;
+    job->count = count;
+    job->interval = interval;
+    job->seq = jobs->NumInList();
+    jobs->Append(job);
+    if (count > 0)
+	pending->Insert(job);
+}
+
+//----------------------------------------------------------------------
+// Workload::Load
+// 	Add each job in a workload file.  A line that isn't a job, or
+//	blank, or a comment, is fatal.
+//----------------------------------------------------------------------
+
+void
+Workload::Load(char *fileName)
+{
+    FILE *file = fopen(fileName, "r");
+    char line[512], program[256];
+    int priority, arrival, count, interval, lineNum = 0;
+
+    if (file == NULL) {
+	cerr << "Can't open workload " << fileName << "\n";
+	ASSERTNOTREACHED();
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+	char *comment = strchr(line, '#');
+	int n;
+
+	lineNum++;
+	if (comment != NULL)
+	    *comment = '\0';
+	count = 1;
+	interval = 0;
+	n = sscanf(line, "%255s %d %d %d %d", program, &priority, &arrival,
+		   &count, &interval);
+	if (n <= 0)
+	    continue;			// nothing but white space
+	if (n < 3 || arrival < 0 || count < 0 || interval < 0) {
+	    cerr << fileName << ":" << lineNum << ": not a job\n";
+	    ASSERTNOTREACHED();
+	}
+	Add(program, priority, arrival, count, interval);
+    }
+    fclose(file);
+}
+
+//----------------------------------------------------------------------
+// Workload::Start
+// 	Start the jobs that arrive at once, and set an interrupt for
+//	the next arrival.  Arrival ticks count from now.
+//----------------------------------------------------------------------
+
+void
+Workload::Start()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    startTick = kernel->stats->totalTicks;
+    StartDue();
+    ScheduleNext();
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Workload::CallBack
+// 	The interrupt handler for an arrival: start the jobs that have
+//	arrived, and set an interrupt for the next.
+//----------------------------------------------------------------------
+
+void
+Workload::CallBack()
+{
+    StartDue();
+    ScheduleNext();
+}
+
+//----------------------------------------------------------------------
+// Workload::StartDue
+// 	Start a copy of each job that is due by now.  A job with more
+//	copies to start goes back among the pending jobs, due again
+//	"interval" ticks later (at once, if the interval is 0).
+//----------------------------------------------------------------------
+
+void
+Workload::StartDue()
+{
+    int now = kernel->stats->totalTicks - startTick;
+
+    while (!pending->IsEmpty() && pending->Min()->arrival <= now) {
+	Job *job = pending->RemoveMin();
+
+	DEBUG(dbgThread, "Workload starting " << job->program << " at tick "
+	      << kernel->stats->totalTicks);
+	kernel->Exec(job->program, job->priority, NULL);	// no parent
+	numStarted++;
+	if (--job->count > 0) {
+	    job->arrival += job->interval;
+	    pending->Insert(job);
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// Workload::ScheduleNext
+// 	Set an interrupt for when the next job arrives, if any is still
+//	to come.
+//----------------------------------------------------------------------
+
+void
+Workload::ScheduleNext()
+{
+    if (!pending->IsEmpty())
+	kernel->interrupt->Schedule(this, startTick + pending->Min()->arrival
+				    - kernel->stats->totalTicks, WorkloadInt);
+}
+
+//----------------------------------------------------------------------
+// Workload::Exited
+// 	One of the programs started has exited.  If it was the last one,
+//	and no more are to come, the workload is over, and so is the
+//	simulation -- otherwise the console would keep it idling forever.
+//----------------------------------------------------------------------
+
+void
+Workload::Exited()
+{
+    numExited++;
+    if (numExited == numStarted && pending->IsEmpty()) {
+	cout << "All " << numStarted << " programs of the workload have exited.\n";
+	kernel->interrupt->Halt();
+    }
+}
@@ -0,0 +1,78 @@
+// workload.h
+//	Data structures for a workload: the user programs to run, and
+//	when each is to start.
+//
+//	A workload is a list of jobs, each a program to run at some
+//	priority, arriving at some tick, perhaps repeated every so many
+//	ticks after that.  The jobs come from -e and -ep (which arrive
+//	at tick 0, in order), and from workload files (-wl), with a job
+//	to a line:
+//
+//		<program> <priority> <arrival tick> [<count> [<interval>]]
+//
+//	"count" copies of the program (default 1) are started, the
+//	first at the arrival tick and then one every "interval" ticks
+//	(default 0, all at once).  A "#" starts a comment.  For example,
+//
+//		# a CPU hog, and 500 short I/O jobs arriving once a second
+//		../test/cpubound  40  0
+//		../test/iobound  120  1000  500  1000
+//
+//	Jobs that have arrived are started from an interrupt handler,
+//	just as if a user had typed them in; the machine halts when
+//	every job has started and exited.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "callback.h"
+#include "heap.h"
+#include "list.h"
+
+// A line of the workload: the copies of a program still to start.
+
+class Job {
+  public:
+    char *program;		// the executable's file name
+    int priority;		// the priority to run it at
+    int arrival;		// when the next copy starts
+    int count;			// how many copies are still to start
+    int interval;		// ticks between copies
+    int seq;			// which line it was, to start jobs that
+				// arrive together in order
+};
+
+class Workload : public CallBackObj {
+  public:
+    Workload();			// an empty workload
+    ~Workload();
+
+    void Add(char *program, int priority, int arrival, int count,
+	     int interval);	// add a job
+    void Load(char *fileName);	// add the jobs in a workload file
+
+    void Start();		// start the jobs that arrive now, and
+				// schedule an interrupt for the rest
+    void Exited();		// one of the programs has exited; halt
+				// if it was the last
+
+  private:
+    void CallBack();		// the next job has arrived
+    void StartDue();		// start every job due by now
+    void ScheduleNext();	// set an interrupt for the next arrival
+
+    List<Job *> *jobs;		// every job added
+    Heap<Job *> *pending;	// jobs with copies still to start,
+				// the next to arrive first
+    int startTick;		// when the workload started
+    int numStarted;		// programs started
+    int numExited;		// and how many of them have exited
+};
+
+#endif // WORKLOAD_H
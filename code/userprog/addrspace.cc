@@ -20,9 +20,7 @@
 #include "addrspace.h"
 #include "machine.h"
 #include "noff.h"
-
-bool AddrSpace::usedPhyPage[NumPhysPages] = {0};
-int AddrSpace::numOfUsedPhyPage = 0;
+#include "memorymanager.h"
 
 //----------------------------------------------------------------------
 // SwapHeader
@@ -70,47 +68,62 @@ SwapHeader (NoffHeader *noffH)
 
 AddrSpace::AddrSpace()
 {
-    // We don't need this anymore because we have to assign the physical memory manually.
-    /* 
-    pageTable = new TranslationEntry[NumPhysPages];
-    for (int i = 0; i < NumPhysPages; i++) {
-	pageTable[i].virtualPage = i;	// for now, virt page # = phys page #
-	pageTable[i].physicalPage = i;
-	pageTable[i].valid = TRUE;
-	pageTable[i].use = FALSE;
-	pageTable[i].dirty = FALSE;
-	pageTable[i].readOnly = FALSE;  
-    }
-    
-    // zero out the entire address space
-    bzero(kernel->machine->mainMemory, MemorySize);
-    
-    */
+    // Nothing to set up until we know how big the program is: the
+    // page table is built, and pages are given frames by the memory
+    // manager, in Load.
+    pageTable = NULL;
+    swapSector = NULL;
+    numPages = 0;
+    executable = NULL;
 }
 
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-// 	Dealloate an address space.
+// 	Dealloate an address space, giving its frames and swap sectors
+//	back to the memory manager.
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace()
 {
-    // Decrease the numOfUsedPhyPage.
-    AddrSpace::numOfUsedPhyPage -= numPages;
-    // Disable the physical pages this address space used.
-    for (int i = 0; i < numPages; i++) {
-        AddrSpace::usedPhyPage[pageTable[i].physicalPage] = false;
-    }
-    delete pageTable;
+    if (pageTable == NULL)		// Load never got that far
+        return;
+    kernel->memoryManager->ReleasePages(this);
+    delete [] pageTable;
+    delete [] swapSector;
+    delete executable;
 }
 
+//----------------------------------------------------------------------
+// ReadSegmentPage
+// 	Copy the part of a segment of the object file that falls in
+//	a given virtual page into "page", which holds the contents of
+//	that page.  Parts of the page outside the segment are left alone.
+//
+//	"executable" -- the object file
+//	"segment" -- where the segment is, in the file and in memory
+//	"vpn" -- the virtual page being filled in
+//	"page" -- PageSize bytes for the contents of the page
+//----------------------------------------------------------------------
+
+static void
+ReadSegmentPage(OpenFile *executable, Segment *segment, int vpn, char *page)
+{
+    int pageStart = vpn * PageSize;
+    int start = max(segment->virtualAddr, pageStart);
+    int end = min(segment->virtualAddr + segment->size, pageStart + PageSize);
+
+    if (start >= end)			// doesn't overlap the page
+        return;
+    executable->ReadAt(&page[start - pageStart], end - start,
+                       segment->inFileAddr + (start - segment->virtualAddr));
+}
 
 //----------------------------------------------------------------------
 // AddrSpace::Load
-// 	Load a user program into memory from a file.
+// 	Set up an address space for a user program in a file.  Nothing
+//	is read into memory here: pages are faulted in on first touch.
 //
-//	Assumes that the page table has been initialized, and that
-//	the object code file is in NOFF format.
+//	Assumes that the object code file is in NOFF format.
 //
 //	"fileName" is the file containing the object code to load into memory
 //----------------------------------------------------------------------
@@ -118,10 +131,10 @@ AddrSpace::~AddrSpace()
 bool 
 AddrSpace::Load(char *fileName) 
 {
-    OpenFile *executable = kernel->fileSystem->Open(fileName);
-    NoffHeader noffH;
     unsigned int size;
 
+    executable = kernel->fileSystem->Open(fileName);
+
     if (executable == NULL) {
 	cerr << "Unable to open file " << fileName << "\n";
 	return FALSE;
@@ -147,63 +160,48 @@ AddrSpace::Load(char *fileName)
 #endif
     numPages = divRoundUp(size, PageSize);
     size = numPages * PageSize;
-    
-    // Check if we have enough physical memory.
-    ASSERT(AddrSpace::numOfUsedPhyPage + numPages <= NumPhysPages);
-    AddrSpace::numOfUsedPhyPage += numPages;
-    
-    // New a pageTable for this address space, and map virtual page to physical page.
-    pageTable = new TranslationEntry[numPages];
-    for (int i = 0; i < numPages; i++) {
-        for (int j = 0; j < NumPhysPages; j++) {
-            if (!AddrSpace::usedPhyPage[j]) {
-                AddrSpace::usedPhyPage[j] = true;
-                pageTable[i].virtualPage = i; // Virtual page num.
-                pageTable[i].physicalPage = j;// Physical page num.
-                pageTable[i].valid = TRUE;    // It is valid after mapping.
-                pageTable[i].use = FALSE;
-                pageTable[i].dirty = FALSE;
-                pageTable[i].readOnly = FALSE;  
-                break;
-            }
-        }
-    }
 
     DEBUG(dbgAddr, "Initializing address space: " << numPages << ", " << size);
 
-// then, copy in the code and data segments into memory
-// Note: this code assumes that virtual address = physical address
-    if (noffH.code.size > 0) {
-        DEBUG(dbgAddr, "Initializing code segment.");
-        DEBUG(dbgAddr, noffH.code.virtualAddr << ", " << noffH.code.size);
-        // Use virtual address to calculate the offset and virtual page number.
-        int offset = noffH.code.virtualAddr % PageSize, vpn = noffH.code.virtualAddr / PageSize;
-        // We can use virtual page number to find physical page number via page table.
-        executable->ReadAt(&(kernel->machine->mainMemory[pageTable[vpn].physicalPage * PageSize + offset]), 
-			noffH.code.size, noffH.code.inFileAddr);
-    }
-    if (noffH.initData.size > 0) {
-        DEBUG(dbgAddr, "Initializing data segment.");
-        DEBUG(dbgAddr, noffH.initData.virtualAddr << ", " << noffH.initData.size);
-        // Use virtual address to calculate the offset and virtual page number.
-        int offset = noffH.initData.virtualAddr % PageSize, vpn = noffH.initData.virtualAddr / PageSize;
-        // We can use virtual page number to find physical page number via page table.
-        executable->ReadAt(&(kernel->machine->mainMemory[pageTable[vpn].physicalPage * PageSize + offset]),
-			noffH.initData.size, noffH.initData.inFileAddr);
+    // Build the page table.  None of the pages are in memory yet:
+    // each one is loaded (see InitialPage) when it is first touched,
+    // so we keep the object file open until the address space goes.
+    pageTable = new TranslationEntry[numPages];
+    swapSector = new int[numPages];
+    for (unsigned int i = 0; i < numPages; i++) {
+        pageTable[i].virtualPage = i;
+        pageTable[i].physicalPage = -1;
+        pageTable[i].valid = FALSE;
+        pageTable[i].use = FALSE;
+        pageTable[i].dirty = FALSE;
+        pageTable[i].readOnly = FALSE;
+        swapSector[i] = -1;
     }
 
+    return TRUE;			// success
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::InitialPage
+// 	Fill in the contents a page has before the program touches it:
+//	whatever parts of the code and data segments fall in it, and
+//	zeroes for the rest (uninitialized data, the stack).  Called by
+//	the memory manager the first time the page is faulted in, and
+//	again if it is evicted without having been modified.
+//
+//	"vpn" -- the virtual page
+//	"page" -- where to put its PageSize bytes
+//----------------------------------------------------------------------
+
+void
+AddrSpace::InitialPage(int vpn, char *page)
+{
+    bzero(page, PageSize);
+    ReadSegmentPage(executable, &noffH.code, vpn, page);
+    ReadSegmentPage(executable, &noffH.initData, vpn, page);
 #ifdef RDATA
-    if (noffH.readonlyData.size > 0) {
-        DEBUG(dbgAddr, "Initializing read only data segment.");
-	DEBUG(dbgAddr, noffH.readonlyData.virtualAddr << ", " << noffH.readonlyData.size);
-        executable->ReadAt(
-		&(kernel->machine->mainMemory[noffH.readonlyData.virtualAddr]),
-			noffH.readonlyData.size, noffH.readonlyData.inFileAddr);
-    }
+    ReadSegmentPage(executable, &noffH.readonlyData, vpn, page);
 #endif
-
-    delete executable;			// close file
-    return TRUE;			// success
 }
 
 //----------------------------------------------------------------------
@@ -272,11 +270,16 @@ AddrSpace::InitRegisters()
 // 	On a context switch, save any machine state, specific
 //	to this address space, that needs saving.
 //
-//	For now, don't need to save anything!
+//	With a TLB, its entries are ours, so they have to go (after
+//	passing their use and dirty bits on to our page table).
 //----------------------------------------------------------------------
 
 void AddrSpace::SaveState() 
 {
+    if (kernel->machine->tlb != NULL) {
+	kernel->tlbManager->Flush();
+	return;
+    }
     pageTable = kernel->machine->pageTable;
 	numPages = kernel->machine->pageTableSize;
 }
@@ -286,16 +289,36 @@ void AddrSpace::SaveState()
 // 	On a context switch, restore the machine state so that
 //	this address space can run.
 //
-//      For now, tell the machine where to find the page table.
+//      For now, tell the machine where to find the page table, and
+//	throw away the translations it cached from the old one.
+//	With a TLB, there is nothing to do: it was emptied when the
+//	old address space was saved, and it fills up again on demand.
 //----------------------------------------------------------------------
 
 void AddrSpace::RestoreState() 
 {
+    if (kernel->machine->tlb != NULL)
+	return;
     kernel->machine->pageTable = pageTable;
     kernel->machine->pageTableSize = numPages;
+    kernel->machine->FlushHostTLB();	// those were somebody else's pages
 }
 
 
+//----------------------------------------------------------------------
+// AddrSpace::PageEntry
+//  Return the page table entry of virtual page _vpn_, so that the
+//  kernel can load it into the TLB, or NULL if the address space
+//  doesn't have such a page.
+//----------------------------------------------------------------------
+TranslationEntry *
+AddrSpace::PageEntry(unsigned int vpn)
+{
+    if (vpn >= numPages)
+        return NULL;
+    return &pageTable[vpn];
+}
+
 //----------------------------------------------------------------------
 // AddrSpace::Translate
 //  Translate the virtual address in _vaddr_ to a physical address
@@ -326,7 +349,7 @@ AddrSpace::Translate(unsigned int vaddr, unsigned int *paddr, int isReadWrite)
 
     // if the pageFrame is too big, there is something really wrong!
     // An invalid translation was loaded into the page table or TLB.
-    if (pfn >= NumPhysPages) {
+    if (pfn >= kernel->machine->numPhysPages) {
         DEBUG(dbgAddr, "Illegal physical page " << pfn);
         return BusErrorException;
     }
@@ -338,7 +361,7 @@ AddrSpace::Translate(unsigned int vaddr, unsigned int *paddr, int isReadWrite)
 
     *paddr = pfn*PageSize + offset;
 
-    ASSERT((*paddr < MemorySize));
+    ASSERT(*paddr < (unsigned int) kernel->machine->memorySize);
 
     //cerr << " -- AddrSpace::Translate(): vaddr: " << vaddr <<
     //  ", paddr: " << *paddr << "\n";
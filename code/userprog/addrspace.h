@@ -15,6 +15,7 @@
 
 #include "copyright.h"
 #include "filesys.h"
+#include "noff.h"
 
 #define UserStackSize		1024 	// increase this as necessary!
 
@@ -38,15 +39,28 @@ class AddrSpace {
     // to physical address _paddr_. _mode_
     // is 0 for Read, 1 for Write.
     ExceptionType Translate(unsigned int vaddr, unsigned int *paddr, int mode);
-    
-    static bool usedPhyPage[NumPhysPages];
-    static int numOfUsedPhyPage;
 
+    TranslationEntry *PageEntry(unsigned int vpn);
+					// Return the page table entry of 
+					// virtual page _vpn_, or NULL if it 
+					// is outside the address space
+    
   private:
     TranslationEntry *pageTable;	// Assume linear page table translation
 					// for now!
     unsigned int numPages;		// Number of pages in the virtual 
 					// address space
+    int *swapSector;			// Where each page is kept in the
+					// swap area, -1 if it has never
+					// been there
+    OpenFile *executable;		// The object file, kept open to
+    NoffHeader noffH;			// load pages from on first touch
+
+    void InitialPage(int vpn, char *page);
+					// Fill in the contents of a page
+					// that has never been written out
+
+    friend class MemoryManager;		// moves our pages in and out
 
     void InitRegisters();		// Initialize user-level CPU registers,
 					// before jumping to user code
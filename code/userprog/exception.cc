@@ -25,6 +25,40 @@
 #include "main.h"
 #include "syscall.h"
 #include "ksyscall.h"
+#include "tlbmanager.h"
+#include "memorymanager.h"
+
+//----------------------------------------------------------------------
+// HandlePageFault
+// 	There is no translation for the page at "badVAddr": either the
+//	page is not in memory, or (if the machine has a TLB) it just
+//	isn't in the TLB.  Page it in from the swap area if needed, and
+//	then load it into the TLB.  We don't touch the PC, so the
+//	hardware retries the instruction that faulted when we return.
+//
+//	PageIn can let other threads run once the page is mapped (when
+//	it releases the paging lock), and one of them may evict the page
+//	again before we get back; if so, page it in again.
+//----------------------------------------------------------------------
+
+static void
+HandlePageFault(int badVAddr)
+{
+    AddrSpace *space = kernel->currentThread->space;
+    unsigned int vpn = (unsigned) badVAddr / PageSize;
+    TranslationEntry *pte = space->PageEntry(vpn);
+
+    DEBUG(dbgAddr, "Page fault at " << badVAddr);
+    if (pte == NULL) {
+	cerr << "Illegal virtual address " << badVAddr << "\n";
+	ASSERTNOTREACHED();
+    }
+    while (!pte->valid)
+	kernel->memoryManager->PageIn(space, vpn);
+    if (kernel->tlbManager != NULL)
+	kernel->tlbManager->Load(pte);
+}
+
 //----------------------------------------------------------------------
 // ExceptionHandler
 // 	Entry point into the Nachos kernel.  Called when a user program
@@ -73,6 +107,15 @@ ExceptionHandler(ExceptionType which)
             return;
             ASSERTNOTREACHED();
             break;
+        case SC_Sleep:
+            DEBUG(dbgSys, "Sleep " << kernel->machine->ReadRegister(4) << "\n");
+            SysSleep(kernel->machine->ReadRegister(4));
+            kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
+			kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
+			kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
+            return;
+            ASSERTNOTREACHED();
+            break;
         case SC_Open:
             val = kernel->machine->ReadRegister(4);
             {
@@ -178,6 +221,7 @@ ExceptionHandler(ExceptionType which)
 			DEBUG(dbgAddr, "Program exit\n");
             val=kernel->machine->ReadRegister(4);
             cout << "return value:" << val << endl;
+			kernel->workload->Exited();	// halts after the last one
 			kernel->currentThread->Finish();
             break;
       	default:
@@ -185,6 +229,9 @@ ExceptionHandler(ExceptionType which)
 			break;
 		}
 		break;
+	case PageFaultException:
+		HandlePageFault(kernel->machine->ReadRegister(BadVAddrReg));
+		return;
 	default:
 		cerr << "Unexpected user mode exception " << (int)which << "\n";
 		break;
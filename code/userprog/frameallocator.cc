@@ -0,0 +1,166 @@
+// frameallocator.cc
+//	Routines to allocate and free physical page frames, using a
+//	two-level bitmap of the free frames (see frameallocator.h).
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "bitmap.h"
+#include "frameallocator.h"
+
+//----------------------------------------------------------------------
+// FrameAllocator::FrameAllocator
+// 	Initialize an allocator for "numFrames" frames, all free.
+//----------------------------------------------------------------------
+
+FrameAllocator::FrameAllocator(int numFrames)
+{
+    int numWords = divRoundUp(numFrames, BitsInWord);
+    int i;
+
+    ASSERT(numFrames > 0);
+    this->numFrames = numFrames;
+    numFree = 0;
+    freeMap = new unsigned int[numWords];
+    numSummaryWords = divRoundUp(numWords, BitsInWord);
+    summary = new unsigned int[numSummaryWords];
+    info = new FrameInfo[numFrames];
+
+    for (i = 0; i < numWords; i++)
+	freeMap[i] = 0;
+    for (i = 0; i < numSummaryWords; i++)
+	summary[i] = 0;
+    searchFrom = 0;
+    for (i = 0; i < numFrames; i++) {
+	info[i].owner = NULL;
+	info[i].virtualPage = -1;
+	info[i].refCount = 0;
+	MarkFree(i);
+    }
+}
+
+//----------------------------------------------------------------------
+// FrameAllocator::~FrameAllocator
+// 	De-allocate the bitmaps and the per-frame information.
+//----------------------------------------------------------------------
+
+FrameAllocator::~FrameAllocator()
+{
+    delete [] freeMap;
+    delete [] summary;
+    delete [] info;
+}
+
+//----------------------------------------------------------------------
+// FrameAllocator::MarkFree, FrameAllocator::MarkUsed
+// 	Set or clear the bit of a frame, keeping the summary bit of its
+//	word, and the place to start searching, up to date.
+//----------------------------------------------------------------------
+
+void
+FrameAllocator::MarkFree(int frame)
+{
+    int word = frame / BitsInWord;
+
+    ASSERT((freeMap[word] & (1U << (frame % BitsInWord))) == 0);
+    freeMap[word] |= 1U << (frame % BitsInWord);
+    summary[word / BitsInWord] |= 1U << (word % BitsInWord);
+    if (word / BitsInWord < searchFrom)
+	searchFrom = word / BitsInWord;
+    numFree++;
+}
+
+void
+FrameAllocator::MarkUsed(int frame)
+{
+    int word = frame / BitsInWord;
+
+    ASSERT(freeMap[word] & (1U << (frame % BitsInWord)));
+    freeMap[word] &= ~(1U << (frame % BitsInWord));
+    if (freeMap[word] == 0)
+	summary[word / BitsInWord] &= ~(1U << (word % BitsInWord));
+    numFree--;
+}
+
+//----------------------------------------------------------------------
+// FrameAllocator::Allocate
+// 	Return the lowest numbered free frame, now with one user, or -1
+//	if every frame is in use.
+//----------------------------------------------------------------------
+
+int
+FrameAllocator::Allocate()
+{
+    int frame;
+
+    if (numFree == 0)
+	return -1;
+    while (summary[searchFrom] == 0)	// there is a free frame, so
+	searchFrom++;			// this stops
+    int word = searchFrom * BitsInWord + FirstSet(summary[searchFrom]);
+    frame = word * BitsInWord + FirstSet(freeMap[word]);
+
+    MarkUsed(frame);
+    info[frame].refCount = 1;
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// FrameAllocator::Retain, FrameAllocator::Release
+// 	Add or remove a user of an allocated frame.  When the last one
+//	goes, the frame is free again, and forgets what was in it.
+//----------------------------------------------------------------------
+
+void
+FrameAllocator::Retain(int frame)
+{
+    ASSERT(info[frame].refCount > 0);
+    info[frame].refCount++;
+}
+
+void
+FrameAllocator::Release(int frame)
+{
+    ASSERT(info[frame].refCount > 0);
+    if (--info[frame].refCount > 0)
+	return;
+    info[frame].owner = NULL;
+    info[frame].virtualPage = -1;
+    MarkFree(frame);
+}
+
+//----------------------------------------------------------------------
+// FrameAllocator::SelfTest
+// 	Check that frames come out lowest first, that they are only
+//	freed by their last user, and that a freed frame is the next
+//	one handed out.
+//
+//	Must be called on an allocator of at least four frames, with
+//	none of them in use.
+//----------------------------------------------------------------------
+
+void
+FrameAllocator::SelfTest()
+{
+    int i;
+
+    ASSERT(numFrames >= 4 && numFree == numFrames);
+    for (i = 0; i < numFrames; i++)
+	ASSERT(Allocate() == i);
+    ASSERT(Allocate() == -1 && NumFree() == 0);
+
+    Retain(numFrames / 3);
+    Release(numFrames / 3);
+    ASSERT(NumFree() == 0);		// still has a user
+    Release(numFrames / 3);
+    Release(numFrames - 1);
+    ASSERT(Allocate() == numFrames / 3);
+    ASSERT(Allocate() == numFrames - 1);
+
+    for (i = 0; i < numFrames; i++)
+	Release(i);
+    ASSERT(NumFree() == numFrames);
+}
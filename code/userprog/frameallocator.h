@@ -0,0 +1,71 @@
+// frameallocator.h
+//	Data structures for allocating physical page frames.
+//
+//	Free frames are kept in a bitmap (a set bit means the frame is
+//	free), with a summary bitmap on top of it that has one bit per
+//	word of the bitmap, set if that word has any free frame in it.
+//	Finding the lowest free frame then takes two find-first-set
+//	operations, and a scan of the summary that starts where the
+//	lowest free frame might be -- so it stays fast with tens of
+//	thousands of frames.
+//
+//	The allocator also keeps what the kernel needs to know about
+//	each frame: the page in it, and how many users it has.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FRAMEALLOCATOR_H
+#define FRAMEALLOCATOR_H
+
+#include "copyright.h"
+#include "utility.h"
+
+class AddrSpace;
+
+// What we know about each physical page frame
+
+class FrameInfo {
+  public:
+    AddrSpace *owner;		// the address space whose page is in the
+				// frame, or NULL if there isn't one
+    int virtualPage;		// which of its pages it is
+    int refCount;		// how many users the frame has; it is
+				// free when this drops to zero
+};
+
+class FrameAllocator {
+  public:
+    FrameAllocator(int numFrames);	// all frames start out free
+    ~FrameAllocator();
+
+    int Allocate();			// return the lowest free frame, with
+					// a reference count of one, or -1 if
+					// there are no free frames
+    void Retain(int frame);		// add a user to an allocated frame
+    void Release(int frame);		// remove one; free the frame if
+					// it was the last
+
+    FrameInfo *Info(int frame) { return &info[frame]; }
+    int NumFrames() { return numFrames; }
+    int NumFree() { return numFree; }
+
+    void SelfTest();			// test whether the allocator works
+
+  private:
+    void MarkFree(int frame);		// update both bitmaps
+    void MarkUsed(int frame);
+
+    int numFrames;
+    int numFree;
+    unsigned int *freeMap;		// one bit per frame, set if free
+    unsigned int *summary;		// one bit per word of freeMap, set
+					// if the word has a bit set
+    int numSummaryWords;
+    int searchFrom;			// no summary word below this one has
+					// a bit set
+    FrameInfo *info;			// one per frame
+};
+
+#endif // FRAMEALLOCATOR_H
@@ -30,6 +30,11 @@ void SysPrintInt(int number) {
     kernel->interrupt->PrintInt(number);
 }
 
+void SysSleep(int ticks)
+{
+  kernel->alarm->WaitUntil(ticks);
+}
+
 int SysCreate(char *filename)
 {
 	// return value
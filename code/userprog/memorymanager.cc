@@ -0,0 +1,269 @@
+// memorymanager.cc
+//	Routines for demand paging: allocating physical page frames,
+//	evicting pages to the swap area on the simulated disk, and
+//	reading them back in on a page fault.
+//
+//	The page to evict is chosen by a ReplacementPolicy (see
+//	replacement.h), picked with the -pr flag.  Disk I/O blocks the
+//	calling thread, so other threads can run -- and fault -- in the
+//	meantime; pagingLock makes them wait until we're done moving
+//	our page.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "memorymanager.h"
+#include "addrspace.h"
+#include "synch.h"
+#include "synchdisk.h"
+#include "tlbmanager.h"
+
+//----------------------------------------------------------------------
+// MemoryManager::MemoryManager
+// 	Initialize the frame table, with a frame for each page of the
+//	machine's physical memory, and the swap area.  Nothing is in
+//	memory or on the swap area yet.
+//
+//	"replacement" -- how to choose the page to evict
+//----------------------------------------------------------------------
+
+MemoryManager::MemoryManager(PageReplacement replacement)
+{
+    int numFrames = kernel->machine->numPhysPages;
+
+    frames = new FrameAllocator(numFrames);
+    switch (replacement) {
+      case FIFOReplacement:
+	policy = new FIFOPolicy();
+	break;
+      case ClockReplacement:
+	policy = new ClockPolicy(numFrames);
+	break;
+      case EnhancedClockReplacement:
+	policy = new EnhancedClockPolicy(numFrames);
+	break;
+      case AgingReplacement:
+	policy = new AgingPolicy(numFrames);
+	break;
+      case WorkingSetReplacement:
+	policy = new WorkingSetPolicy(numFrames);
+	break;
+      default:
+	ASSERTNOTREACHED();
+    }
+    swapMap = new Bitmap(NumSwapSectors);
+    pagingLock = new Lock((char *) "paging");
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::~MemoryManager
+// 	De-allocate the frame table and the swap area map.
+//----------------------------------------------------------------------
+
+MemoryManager::~MemoryManager()
+{
+    delete policy;
+    delete frames;
+    delete swapMap;
+    delete pagingLock;
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::SwapSector
+// 	Return the swap sector holding a virtual page, giving the page
+//	one if it has never been on the swap area before.
+//
+//	"space", "vpn" -- the page
+//----------------------------------------------------------------------
+
+int
+MemoryManager::SwapSector(AddrSpace *space, int vpn)
+{
+    if (space->swapSector[vpn] < 0) {
+	int which = swapMap->FindAndSet();
+
+	if (which < 0) {
+	    cerr << "Out of swap space\n";
+	    ASSERTNOTREACHED();
+	}
+	space->swapSector[vpn] = FirstSwapSector + which;
+    }
+    return space->swapSector[vpn];
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::MapPage
+// 	Make a virtual page resident in a frame whose contents have
+//	already been filled in.
+//
+//	"space", "vpn" -- the page
+//	"frame" -- the physical page frame now holding it
+//----------------------------------------------------------------------
+
+void
+MemoryManager::MapPage(AddrSpace *space, int vpn, int frame)
+{
+    TranslationEntry *pte = &space->pageTable[vpn];
+
+    frames->Info(frame)->owner = space;
+    frames->Info(frame)->virtualPage = vpn;
+    policy->PageLoaded(frame);
+
+    pte->physicalPage = frame;
+    pte->valid = TRUE;
+    pte->use = FALSE;
+    pte->dirty = FALSE;
+
+    // Forget code decoded from the frame's previous contents.
+    kernel->machine->InvalidateDecodeCache(frame);
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::FrameEntry
+// 	Return the page table entry of the page in a frame, for the
+//	replacement policy to look at.  If the page is in the TLB, the
+//	hardware has been setting the use and dirty bits there, so
+//	bring the page table's copy up to date first.
+//
+//	"frame" -- a frame holding a page
+//----------------------------------------------------------------------
+
+TranslationEntry *
+MemoryManager::FrameEntry(int frame)
+{
+    FrameInfo *info = frames->Info(frame);
+    TranslationEntry *pte;
+
+    ASSERT(info->owner != NULL);
+    pte = &info->owner->pageTable[info->virtualPage];
+    if (kernel->tlbManager != NULL)
+	kernel->tlbManager->Sync(pte);
+    return pte;
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::ClearUseBit
+// 	Clear the use bit of the page in a frame, in the page table
+//	and in the TLB, so we can tell if it is used again.  (The host
+//	TLB, which only sets use bits once, is flushed by Evict.)
+//
+//	"frame" -- a frame holding a page
+//----------------------------------------------------------------------
+
+void
+MemoryManager::ClearUseBit(int frame)
+{
+    TranslationEntry *pte = FrameEntry(frame);
+
+    pte->use = FALSE;
+    if (kernel->tlbManager != NULL)
+	kernel->tlbManager->ClearUse(pte);
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::Evict
+// 	Take the page the replacement policy picks away from its
+//	address space, write it to the swap area if the copy there is
+//	out of date, and return the frame it was in.  The frame stays
+//	allocated: the caller is expected to put the next page into it.
+//----------------------------------------------------------------------
+
+int
+MemoryManager::Evict()
+{
+    int victim = policy->FindVictim();
+
+    AddrSpace *owner = frames->Info(victim)->owner;
+    int vpn = frames->Info(victim)->virtualPage;
+    TranslationEntry *pte = &owner->pageTable[vpn];
+
+    DEBUG(dbgAddr, "Evicting virtual page " << vpn << " from frame " << victim);
+
+    // The owner must fault on its next access, starting right now,
+    // so that it doesn't see the frame change while we wait for
+    // the disk.  Flushing the host TLB also makes the next access
+    // to any page whose use bit the policy cleared set it again.
+    if (kernel->tlbManager != NULL)
+	kernel->tlbManager->Invalidate(pte);	// picks up the dirty bit
+    pte->valid = FALSE;
+    kernel->machine->FlushHostTLB();
+    frames->Info(victim)->owner = NULL;		// the page is in transit
+
+    if (pte->dirty) {		// otherwise the swap area or the object
+				// file already has what's in the frame
+	int sector = SwapSector(owner, vpn);
+
+	kernel->stats->numPageWritebacks++;
+	kernel->synchDisk->WriteSector(sector,
+			&kernel->machine->mainMemory[victim * PageSize]);
+    }
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::PageIn
+// 	Handle a page fault on a page of the current address space,
+//	evicting another page if there are no free frames.  A page that
+//	has been written out is read back from the swap area; a page
+//	touched for the first time (or that was clean when it was
+//	evicted, and never written out) gets its initial contents from
+//	the address space -- out of the object file, or zeroes.
+//
+//	"space", "vpn" -- the page that faulted
+//----------------------------------------------------------------------
+
+void
+MemoryManager::PageIn(AddrSpace *space, int vpn)
+{
+    int frame;
+
+    pagingLock->Acquire();
+    kernel->stats->numPageFaults++;
+    ASSERT(!space->pageTable[vpn].valid);
+
+    frame = frames->Allocate();
+    if (frame < 0)
+	frame = Evict();
+    else
+	kernel->stats->numFrameAllocs++;
+    if (frames->NumFrames() - frames->NumFree() > kernel->stats->maxFramesInUse)
+	kernel->stats->maxFramesInUse = frames->NumFrames() - frames->NumFree();
+
+    DEBUG(dbgAddr, "Paging in virtual page " << vpn << " to frame " << frame);
+    if (space->swapSector[vpn] >= 0)
+	kernel->synchDisk->ReadSector(space->swapSector[vpn],
+			&kernel->machine->mainMemory[frame * PageSize]);
+    else
+	space->InitialPage(vpn, &kernel->machine->mainMemory[frame * PageSize]);
+    MapPage(space, vpn, frame);
+    pagingLock->Release();
+}
+
+//----------------------------------------------------------------------
+// MemoryManager::ReleasePages
+// 	Free the frames and the swap sectors of an address space that
+//	is being deleted.  Doesn't block, so it can be called while a
+//	finished thread is being destroyed.
+//
+//	"space" -- the address space going away
+//----------------------------------------------------------------------
+
+void
+MemoryManager::ReleasePages(AddrSpace *space)
+{
+    for (unsigned int vpn = 0; vpn < space->numPages; vpn++) {
+	// (pages on their way out belong to whoever is evicting them)
+	if (space->pageTable[vpn].valid) {
+	    int frame = space->pageTable[vpn].physicalPage;
+
+	    policy->PageReleased(frame);
+	    frames->Release(frame);
+	    kernel->stats->numFrameFrees++;
+	}
+	if (space->swapSector[vpn] >= 0)
+	    swapMap->Clear(space->swapSector[vpn] - FirstSwapSector);
+    }
+}
@@ -0,0 +1,83 @@
+// memorymanager.h
+//	Data structures for demand paging: sharing the physical page
+//	frames among address spaces, and keeping the pages that don't
+//	fit in a swap area on the simulated disk.
+//
+//	A virtual page is either resident (its page table entry is valid
+//	and names the frame holding it), or it is not, and touching it
+//	causes a PageFaultException.  The kernel then calls
+//	MemoryManager::PageIn, which finds a frame for it -- evicting
+//	somebody else's page if there are no free frames left -- and
+//	fills it in: from the swap area if the page has been written out,
+//	otherwise with its initial contents from the object file.
+//	Nothing is loaded until it is touched.
+//
+//	A page keeps its swap sector from the first time it is written
+//	out until its address space goes away, so a page that hasn't
+//	been modified since it was last read in can be evicted without
+//	any disk I/O.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef MEMORYMANAGER_H
+#define MEMORYMANAGER_H
+
+#include "copyright.h"
+#include "disk.h"
+#include "machine.h"
+#include "bitmap.h"
+#include "replacement.h"
+#include "frameallocator.h"
+
+class AddrSpace;
+class Lock;
+
+// The swap area is at the end of the disk.  With the stub file system,
+// nobody else uses the disk, so the swap area can have all of it.
+// Otherwise, the real file system marks these sectors as in use when it
+// formats the disk.  A page fits in exactly one sector.
+
+#ifdef FILESYS_STUB
+const int NumSwapSectors = NumSectors;
+#else
+const int NumSwapSectors = NumSectors / 2;
+#endif
+const int FirstSwapSector = NumSectors - NumSwapSectors;
+
+class MemoryManager {
+  public:
+    MemoryManager(PageReplacement replacement);
+					// all frames free, swap area empty
+    ~MemoryManager();
+
+    void PageIn(AddrSpace *space, int vpn);
+					// Make a non-resident page resident,
+					// evicting another page if needed
+
+    void ReleasePages(AddrSpace *space);
+					// Free the frames and swap sectors of
+					// an address space that is going away
+
+    TranslationEntry *FrameEntry(int frame);
+					// The page table entry of the page in
+					// "frame", with up to date use and
+					// dirty bits
+    void ClearUseBit(int frame);	// Clear the use bit of that page
+
+  private:
+    int Evict();			// write a page out, return its frame
+    void MapPage(AddrSpace *space, int vpn, int frame);
+					// make a page resident in "frame"
+    int SwapSector(AddrSpace *space, int vpn);
+					// the page's swap sector, allocating
+					// it if this is its first time out
+
+    FrameAllocator *frames;		// the physical page frames
+    ReplacementPolicy *policy;		// chooses the page to evict
+    Bitmap *swapMap;			// which swap sectors are in use
+    Lock *pagingLock;			// only one page moves at a time
+};
+
+#endif // MEMORYMANAGER_H
@@ -0,0 +1,307 @@
+// replacement.cc
+//	Routines implementing the page replacement policies.
+//
+//	FindVictim is only called when every frame holds a page, and
+//	the frame it returns is no longer tracked by the policy: the
+//	memory manager calls PageLoaded again once the new page is in.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "replacement.h"
+#include "memorymanager.h"
+
+//----------------------------------------------------------------------
+// FIFOPolicy::FIFOPolicy, FIFOPolicy::~FIFOPolicy
+// 	Initialize and de-allocate the list of resident frames.
+//----------------------------------------------------------------------
+
+FIFOPolicy::FIFOPolicy()
+{
+    order = new List<int>;
+}
+
+FIFOPolicy::~FIFOPolicy()
+{
+    delete order;
+}
+
+//----------------------------------------------------------------------
+// FIFOPolicy::PageLoaded, FIFOPolicy::PageReleased
+// 	Keep the list of resident frames in the order their pages
+//	came in.
+//----------------------------------------------------------------------
+
+void
+FIFOPolicy::PageLoaded(int frame)
+{
+    order->Append(frame);
+}
+
+void
+FIFOPolicy::PageReleased(int frame)
+{
+    order->Remove(frame);
+}
+
+//----------------------------------------------------------------------
+// FIFOPolicy::FindVictim
+// 	Evict the oldest page, used or not.
+//----------------------------------------------------------------------
+
+int
+FIFOPolicy::FindVictim()
+{
+    return order->RemoveFront();
+}
+
+//----------------------------------------------------------------------
+// ClockPolicy::ClockPolicy, ClockPolicy::~ClockPolicy
+// 	Initialize a clock of "numFrames" frames, with no pages on its
+//	face; and de-allocate it.
+//----------------------------------------------------------------------
+
+ClockPolicy::ClockPolicy(int numFrames)
+{
+    this->numFrames = numFrames;
+    resident = new bool[numFrames];
+    for (int i = 0; i < numFrames; i++)
+	resident[i] = FALSE;
+    numResident = 0;
+    hand = 0;
+}
+
+ClockPolicy::~ClockPolicy()
+{
+    delete [] resident;
+}
+
+//----------------------------------------------------------------------
+// ClockPolicy::PageLoaded, ClockPolicy::PageReleased
+// 	Keep track of which frames the hand has to look at.
+//----------------------------------------------------------------------
+
+void
+ClockPolicy::PageLoaded(int frame)
+{
+    ASSERT(!resident[frame]);
+    resident[frame] = TRUE;
+    numResident++;
+}
+
+void
+ClockPolicy::PageReleased(int frame)
+{
+    ASSERT(resident[frame]);
+    resident[frame] = FALSE;
+    numResident--;
+}
+
+//----------------------------------------------------------------------
+// ClockPolicy::Advance
+// 	Return the next frame holding a page, starting at the hand, and
+//	move the hand past it.
+//----------------------------------------------------------------------
+
+int
+ClockPolicy::Advance()
+{
+    int frame;
+
+    ASSERT(numResident > 0);
+    do {
+	frame = hand;
+	hand = (hand + 1) % numFrames;
+    } while (!resident[frame]);
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// ClockPolicy::FindVictim
+// 	Give each used page a second chance by clearing its use bit;
+//	evict the first one that hasn't been used since.  This goes
+//	round at most once.
+//----------------------------------------------------------------------
+
+int
+ClockPolicy::FindVictim()
+{
+    MemoryManager *memory = kernel->memoryManager;
+    int frame;
+
+    for (;;) {
+	frame = Advance();
+	if (!memory->FrameEntry(frame)->use)
+	    break;
+	memory->ClearUseBit(frame);
+    }
+    PageReleased(frame);
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// EnhancedClockPolicy::FindVictim
+// 	Look round once for a page that is neither used nor dirty,
+//	without touching anything; then round again for one that isn't
+//	used, clearing use bits on the way.  If that fails too, every
+//	use bit is now clear, so the next time round will succeed.
+//----------------------------------------------------------------------
+
+int
+EnhancedClockPolicy::FindVictim()
+{
+    MemoryManager *memory = kernel->memoryManager;
+    TranslationEntry *pte;
+    int frame, i;
+
+    for (;;) {
+	for (i = 0; i < numResident; i++) {	// (not used, clean)
+	    frame = Advance();
+	    pte = memory->FrameEntry(frame);
+	    if (!pte->use && !pte->dirty) {
+		PageReleased(frame);
+		return frame;
+	    }
+	}
+	for (i = 0; i < numResident; i++) {	// (not used, dirty)
+	    frame = Advance();
+	    pte = memory->FrameEntry(frame);
+	    if (!pte->use) {
+		PageReleased(frame);
+		return frame;
+	    }
+	    memory->ClearUseBit(frame);
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// AgingPolicy::AgingPolicy, AgingPolicy::~AgingPolicy
+// 	Initialize and de-allocate the use histories.
+//----------------------------------------------------------------------
+
+AgingPolicy::AgingPolicy(int numFrames) : ClockPolicy(numFrames)
+{
+    age = new unsigned char[numFrames];
+    for (int i = 0; i < numFrames; i++)
+	age[i] = 0;
+}
+
+AgingPolicy::~AgingPolicy()
+{
+    delete [] age;
+}
+
+//----------------------------------------------------------------------
+// AgingPolicy::PageLoaded
+// 	A new page has no history; the access that faulted it in will
+//	set its use bit before the next page fault.
+//----------------------------------------------------------------------
+
+void
+AgingPolicy::PageLoaded(int frame)
+{
+    ClockPolicy::PageLoaded(frame);
+    age[frame] = 0;
+}
+
+//----------------------------------------------------------------------
+// AgingPolicy::FindVictim
+// 	Shift each page's use bit into its history, and clear it; then
+//	evict the page with the smallest history.  Ties go to the first
+//	one after the hand, so we don't keep picking the same frames.
+//----------------------------------------------------------------------
+
+int
+AgingPolicy::FindVictim()
+{
+    MemoryManager *memory = kernel->memoryManager;
+    int frame, victim = -1;
+
+    for (int i = 0; i < numResident; i++) {
+	frame = Advance();
+	age[frame] >>= 1;
+	if (memory->FrameEntry(frame)->use) {
+	    age[frame] |= 0x80;
+	    memory->ClearUseBit(frame);
+	}
+	if (victim < 0 || age[frame] < age[victim])
+	    victim = frame;
+    }
+    hand = (victim + 1) % numFrames;
+    PageReleased(victim);
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// WorkingSetPolicy::WorkingSetPolicy, WorkingSetPolicy::~WorkingSetPolicy
+// 	Initialize and de-allocate the last use times.
+//----------------------------------------------------------------------
+
+WorkingSetPolicy::WorkingSetPolicy(int numFrames) : ClockPolicy(numFrames)
+{
+    lastUse = new int[numFrames];
+    for (int i = 0; i < numFrames; i++)
+	lastUse[i] = 0;
+}
+
+WorkingSetPolicy::~WorkingSetPolicy()
+{
+    delete [] lastUse;
+}
+
+//----------------------------------------------------------------------
+// WorkingSetPolicy::PageLoaded
+// 	A page that was just faulted in is about to be used.
+//----------------------------------------------------------------------
+
+void
+WorkingSetPolicy::PageLoaded(int frame)
+{
+    ClockPolicy::PageLoaded(frame);
+    lastUse[frame] = kernel->stats->totalTicks;
+}
+
+//----------------------------------------------------------------------
+// WorkingSetPolicy::FindVictim
+// 	Bring the last use times up to date from the use bits (clearing
+//	them), then go round from the hand: evict the first clean page
+//	that has been unused for more than WorkingSetWindow ticks, or
+//	else the first such dirty page, or else -- when every page is
+//	in some working set -- the least recently used one.
+//----------------------------------------------------------------------
+
+int
+WorkingSetPolicy::FindVictim()
+{
+    MemoryManager *memory = kernel->memoryManager;
+    int now = kernel->stats->totalTicks;
+    int frame, oldDirty = -1, oldest = -1;
+
+    for (int i = 0; i < numResident; i++) {
+	frame = Advance();
+	TranslationEntry *pte = memory->FrameEntry(frame);
+
+	if (pte->use) {
+	    lastUse[frame] = now;
+	    memory->ClearUseBit(frame);
+	} else if (now - lastUse[frame] > WorkingSetWindow) {
+	    if (!pte->dirty) {
+		oldest = frame;			// the best we can do
+		oldDirty = -1;
+		break;
+	    } else if (oldDirty < 0) {
+		oldDirty = frame;
+	    }
+	}
+	if (oldest < 0 || lastUse[frame] < lastUse[oldest])
+	    oldest = frame;
+    }
+    frame = (oldDirty >= 0) ? oldDirty : oldest;
+    hand = (frame + 1) % numFrames;
+    PageReleased(frame);
+    return frame;
+}
@@ -0,0 +1,130 @@
+// replacement.h
+//	Data structures for choosing which page to evict when demand
+//	paging runs out of free frames.
+//
+//	The memory manager tells a ReplacementPolicy whenever a frame
+//	gets a page (PageLoaded) or loses it because its address space
+//	went away (PageReleased), and asks it for a victim when it needs
+//	a frame.  Policies look at the use and dirty bits, which the
+//	hardware sets in the page table (or the TLB), through
+//	MemoryManager::FrameEntry, and clear use bits with
+//	MemoryManager::ClearUseBit.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include "copyright.h"
+#include "machine.h"
+#include "list.h"
+
+// The policies to choose from (see the -pr flag)
+
+enum PageReplacement {
+    FIFOReplacement,		// the page resident longest
+    ClockReplacement,		// second chance: skip pages used recently
+    EnhancedClockReplacement,	// prefer unused, then clean pages
+    AgingReplacement,		// approximate LRU with aging counters
+    WorkingSetReplacement	// a page outside its program's working set
+};
+
+// A page is in the working set if it has been used in the last
+// WorkingSetWindow ticks.
+
+const int WorkingSetWindow = 2000;
+
+// The interface every policy provides
+
+class ReplacementPolicy {
+  public:
+    virtual ~ReplacementPolicy() {}
+
+    virtual void PageLoaded(int frame) = 0;	// a page was put in "frame"
+    virtual void PageReleased(int frame) = 0;	// "frame" is free again
+    virtual int FindVictim() = 0;		// choose a frame to evict,
+						// and forget about it
+};
+
+// Evict the page that has been in memory the longest.
+
+class FIFOPolicy : public ReplacementPolicy {
+  public:
+    FIFOPolicy();
+    ~FIFOPolicy();
+
+    void PageLoaded(int frame);
+    void PageReleased(int frame);
+    int FindVictim();
+
+  private:
+    List<int> *order;		// resident frames, oldest page first
+};
+
+// Go round the frames, clearing use bits, until a page that hasn't
+// been used since the hand last went past it turns up.
+
+class ClockPolicy : public ReplacementPolicy {
+  public:
+    ClockPolicy(int numFrames);
+    ~ClockPolicy();
+
+    void PageLoaded(int frame);
+    void PageReleased(int frame);
+    int FindVictim();
+
+  protected:
+    int Advance();		// return the frame under the hand, and
+				// move the hand on
+    int numFrames;		// how many frames there are
+    bool *resident;		// TRUE if the frame holds a page
+    int numResident;		// how many do
+    int hand;			// the next frame to look at
+};
+
+// Like the clock, but a dirty page costs a write to evict, so first
+// look for a page that is neither used nor dirty, then for one that
+// is not used (clearing use bits on the way).
+
+class EnhancedClockPolicy : public ClockPolicy {
+  public:
+    EnhancedClockPolicy(int numFrames) : ClockPolicy(numFrames) {}
+
+    int FindVictim();
+};
+
+// Keep an 8-bit history of the use bit of each page, shifted in on
+// each page fault; the page with the smallest history is (roughly)
+// the least recently used.
+
+class AgingPolicy : public ClockPolicy {
+  public:
+    AgingPolicy(int numFrames);
+    ~AgingPolicy();
+
+    void PageLoaded(int frame);
+    int FindVictim();
+
+  private:
+    unsigned char *age;		// use bit history, newest on top
+};
+
+// Remember when each page was last seen used; evict a page that has
+// dropped out of the working set (preferably a clean one), or the
+// least recently used page if every page is still in it.
+
+class WorkingSetPolicy : public ClockPolicy {
+  public:
+    WorkingSetPolicy(int numFrames);
+    ~WorkingSetPolicy();
+
+    void PageLoaded(int frame);
+    int FindVictim();
+
+  private:
+    int *lastUse;		// when the use bit was last seen set
+};
+
+#endif // REPLACEMENT_H
@@ -34,6 +34,7 @@
 #define SC_ExecV	13
 #define SC_ThreadExit   14
 #define SC_ThreadJoin   15
+#define SC_Sleep	16
 #define SC_Add		42
 #define SC_MSG		100
 #define SC_PrintInt 99
@@ -181,6 +182,11 @@ int ThreadJoin(ThreadId id);
  */
 void ThreadExit(int ExitCode);	
 
+/* Suspend the current thread for (at least) "ticks" ticks of simulated
+ * time, letting other threads run meanwhile.
+ */
+void Sleep(int ticks);
+
 #endif /* IN_ASM */
 
 #endif /* SYSCALL_H */
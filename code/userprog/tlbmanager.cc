@@ -0,0 +1,227 @@
+// tlbmanager.cc
+//	Routines to load and replace the entries of a software-loaded TLB.
+//
+//	The TLB is set-associative: virtual page "vpn" can only be
+//	in set (vpn % numSets), which is the "tlbWays" entries starting
+//	at tlb[set * tlbWays].  A set that still has an invalid entry
+//	never needs to throw a translation away; otherwise "policy"
+//	chooses the victim.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "tlbmanager.h"
+#include "machine.h"
+#include "sysdep.h"
+
+//----------------------------------------------------------------------
+// TLBManager::TLBManager
+// 	Initialize the kernel's view of the TLB, which starts out empty.
+//
+//	"replacement" -- how to choose the entry to throw away when a
+//		set is full
+//----------------------------------------------------------------------
+
+TLBManager::TLBManager(TLBPolicy replacement)
+{
+    Machine *machine = kernel->machine;
+    int numSets = machine->tlbSize / machine->tlbWays;
+    int i;
+
+    ASSERT(machine->tlb != NULL);
+    policy = replacement;
+    source = new TranslationEntry *[machine->tlbSize];
+    for (i = 0; i < machine->tlbSize; i++)
+	source[i] = NULL;
+    hand = new int[numSets];
+    for (i = 0; i < numSets; i++)
+	hand[i] = 0;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::~TLBManager
+// 	De-allocate the kernel's view of the TLB.
+//----------------------------------------------------------------------
+
+TLBManager::~TLBManager()
+{
+    delete [] source;
+    delete [] hand;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::WriteBack
+// 	The hardware only updates the use and dirty bits of the TLB
+//	entry; before the entry goes away (or its use bit is cleared),
+//	pass them on to the page table entry it was loaded from.
+//
+//	"entry" -- the index of the TLB entry
+//----------------------------------------------------------------------
+
+void
+TLBManager::WriteBack(int entry)
+{
+    TranslationEntry *tlbEntry = &kernel->machine->tlb[entry];
+
+    if (tlbEntry->valid && source[entry] != NULL) {
+	if (tlbEntry->use)
+	    source[entry]->use = TRUE;
+	if (tlbEntry->dirty)
+	    source[entry]->dirty = TRUE;
+    }
+}
+
+//----------------------------------------------------------------------
+// TLBManager::FindVictim
+// 	Return the index of the TLB entry to replace in a set:
+//	an invalid one if there is any, otherwise the one the
+//	replacement policy picks.
+//
+//	"set" -- the set the new translation has to go into
+//----------------------------------------------------------------------
+
+int
+TLBManager::FindVictim(int set)
+{
+    Machine *machine = kernel->machine;
+    int ways = machine->tlbWays;
+    int first = set * ways;
+    int victim;
+
+    for (int i = first; i < first + ways; i++)
+	if (!machine->tlb[i].valid)
+	    return i;
+
+    switch (policy) {
+      case TLBRandom:
+	victim = first + RandomNumber() % ways;
+	break;
+
+      case TLBFifo:
+	victim = first + hand[set];
+	hand[set] = (hand[set] + 1) % ways;
+	break;
+
+      case TLBClock:
+	// give each entry used since we last looked a second chance;
+	// this goes round at most once before finding one
+	for (;;) {
+	    TranslationEntry *tlbEntry = &machine->tlb[first + hand[set]];
+
+	    victim = first + hand[set];
+	    hand[set] = (hand[set] + 1) % ways;
+	    if (!tlbEntry->use)
+		break;
+	    WriteBack(victim);		// don't lose the page's use bit
+	    tlbEntry->use = FALSE;
+	}
+	break;
+
+      default:
+	ASSERTNOTREACHED();
+    }
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Load
+// 	Make the TLB translate the virtual page of a page table entry,
+//	replacing some other translation in the set it belongs to.
+//	The hardware retries the faulting instruction when we return.
+//
+//	"pte" -- the valid page table entry of the current address space
+//----------------------------------------------------------------------
+
+void
+TLBManager::Load(TranslationEntry *pte)
+{
+    Machine *machine = kernel->machine;
+    int set = pte->virtualPage % (machine->tlbSize / machine->tlbWays);
+    int victim = FindVictim(set);
+
+    ASSERT(pte->valid);
+    DEBUG(dbgAddr, "TLB load: virtual page " << pte->virtualPage <<
+		   " into entry " << victim);
+    WriteBack(victim);
+    machine->tlb[victim] = *pte;
+    machine->tlb[victim].use = FALSE;
+    machine->tlb[victim].dirty = FALSE;
+    source[victim] = pte;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Invalidate
+// 	Remove the translation of a page from the TLB, because the page
+//	is leaving memory.  Its use and dirty bits are passed on to the
+//	page table entry first, so the caller can tell if the page
+//	needs writing out.
+//
+//	"pte" -- the page table entry of the page
+//----------------------------------------------------------------------
+
+void
+TLBManager::Invalidate(TranslationEntry *pte)
+{
+    Machine *machine = kernel->machine;
+
+    for (int i = 0; i < machine->tlbSize; i++) {
+	if (source[i] == pte) {
+	    WriteBack(i);
+	    machine->tlb[i].valid = FALSE;
+	    source[i] = NULL;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Sync, TLBManager::ClearUse
+// 	Let the page replacement policy see and clear the use bit (and
+//	see the dirty bit) of a page, while its translation may be in
+//	the TLB.
+//
+//	"pte" -- the page table entry of the page
+//----------------------------------------------------------------------
+
+void
+TLBManager::Sync(TranslationEntry *pte)
+{
+    for (int i = 0; i < kernel->machine->tlbSize; i++)
+	if (source[i] == pte)
+	    WriteBack(i);
+}
+
+void
+TLBManager::ClearUse(TranslationEntry *pte)
+{
+    for (int i = 0; i < kernel->machine->tlbSize; i++)
+	if (source[i] == pte)
+	    kernel->machine->tlb[i].use = FALSE;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Flush
+// 	Throw away every translation in the TLB, because the address
+//	space they belong to is being switched out.  Counts what we
+//	throw away, so we can tell how much context switches cost us.
+//----------------------------------------------------------------------
+
+void
+TLBManager::Flush()
+{
+    Machine *machine = kernel->machine;
+    int flushed = 0;
+
+    for (int i = 0; i < machine->tlbSize; i++) {
+	if (machine->tlb[i].valid) {
+	    WriteBack(i);
+	    machine->tlb[i].valid = FALSE;
+	    flushed++;
+	}
+	source[i] = NULL;
+    }
+    kernel->stats->numTLBFlushes++;
+    kernel->stats->numTLBFlushedEntries += flushed;
+}
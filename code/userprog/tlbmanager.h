@@ -0,0 +1,64 @@
+// tlbmanager.h
+//	Data structures for the kernel's management of a software-loaded
+//	TLB (see machine.h).
+//
+//	The hardware only looks translations up in the TLB; when it
+//	can't find one, it traps to the kernel with a PageFaultException.
+//	The kernel then finds the translation in the page table of the
+//	current address space, and loads it into the TLB with
+//	TLBManager::Load, replacing some other entry of the same set.
+//
+//	Since the TLB holds copies of page table entries, the use and
+//	dirty bits set by the hardware have to be copied back to the
+//	page table when an entry is replaced, and when the TLB is
+//	flushed on a context switch.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TLBMANAGER_H
+#define TLBMANAGER_H
+
+#include "copyright.h"
+#include "translate.h"
+
+// How to choose the entry to replace, when a set of the TLB is full
+
+enum TLBPolicy {
+    TLBRandom,			// any entry of the set
+    TLBFifo,			// the entry that was loaded first
+    TLBClock			// the first entry found unused since the
+				// hand last went past it
+};
+
+class TLBManager {
+  public:
+    TLBManager(TLBPolicy replacement);	// initialize an empty TLB
+    ~TLBManager();
+
+    void Load(TranslationEntry *pte);	// copy a page table entry of the
+					// current address space into the TLB
+
+    void Flush();			// empty the TLB, on a context switch
+
+    void Invalidate(TranslationEntry *pte);
+					// remove the translation loaded from
+					// "pte", if it is in the TLB
+    void Sync(TranslationEntry *pte);	// copy its use and dirty bits to "pte"
+    void ClearUse(TranslationEntry *pte);
+					// clear its use bit
+
+  private:
+    int FindVictim(int set);		// choose the entry of "set" to replace
+    void WriteBack(int entry);		// copy the use and dirty bits of a
+					// TLB entry back to the page table
+
+    TLBPolicy policy;
+    TranslationEntry **source;		// the page table entry each TLB entry
+					// was loaded from
+    int *hand;				// per set: the next entry to replace
+					// (FIFO) or to look at (clock)
+};
+
+#endif // TLBMANAGER_H